@@ -14,7 +14,7 @@ int main() {
 
   // Move Enabled
   std::thread thread_3(std::move(thread_1)); // move ctor with named variable
-  std::thread thread_4(std::thread(bar));    // move ctor with tmp variable
+  std::thread thread_4{std::thread(bar)};    // move ctor with tmp variable
   thread_1 = std::move(thread_3);            // move assgn of named variable
   thread_2 = std::thread(bar);               // move assgn of tmp variable
 
@@ -23,6 +23,7 @@ int main() {
 
   thread_1.join();
   thread_2.join();
+  thread_4.join();
 
   return 0;
 }
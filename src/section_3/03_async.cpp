@@ -2,6 +2,7 @@
 #include <future>
 #include <iostream>
 #include <string>
+#include <thread>
 
 void printing() {
   std::cout << "printing runs on-" << std::this_thread::get_id() << std::endl;
@@ -1,6 +1,7 @@
 #include <future>
 #include <iostream>
 #include <numeric>
+#include <thread>
 #include <vector>
 
 int MIN_ELEMENT_COUNT = 1000;
@@ -1,52 +1,100 @@
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <random>
 #include <ratio>
 #include <stddef.h>
 #include <stdio.h>
+#include <string>
 #include <vector>
 
 #include <execution>
 
-const size_t testSize = 1'000'000;
-const int iterationCount = 5;
+#include "parallel_sort.h"
+#include "radix_sort.h"
+#include "section_8/thread_pool.h"
 
-void print_results(const char *const tag, const std::vector<double> &sorted,
+const size_t maxTestSize = 100'000'000;
+const int iterationCount = 3;
+
+template <typename T>
+void print_results(const char *const tag, const std::vector<T> &sorted,
                    std::chrono::high_resolution_clock::time_point startTime,
                    std::chrono::high_resolution_clock::time_point endTime) {
-  printf("%s: Lowest: %g Highest: %g Time: %fms\n", tag, sorted.front(),
-         sorted.back(),
+  printf("%s: Lowest: %g Highest: %g Sorted: %s Time: %fms\n", tag,
+         static_cast<double>(sorted.front()),
+         static_cast<double>(sorted.back()),
+         std::is_sorted(sorted.begin(), sorted.end()) ? "yes" : "NO",
          std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
              endTime - startTime)
              .count());
 }
 
-int main() {
+// Times sort_function on iterationCount copies of the input.
+template <typename T, typename SortFunction>
+void benchmark(const char *const tag, const std::vector<T> &values,
+               SortFunction sort_function) {
+  for (int i = 0; i < iterationCount; ++i) {
+    std::vector<T> sorted(values);
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    sort_function(sorted);
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    print_results(tag, sorted, startTime, endTime);
+  }
+}
 
-  // generate some random doubles:
-  printf("Testing with %zu doubles...\n", testSize);
-  std::random_device rd;
-  std::vector<double> doubles(testSize);
-  for (auto &d : doubles) {
-    d = static_cast<double>(rd());
+// Compares every sort on random values of type T.
+template <typename T>
+void benchmark_all(thread_pool &pool, const char *const type_name,
+                   size_t testSize, bool comparison_sorts) {
+  // generate some random values:
+  printf("Testing with %zu %s...\n", testSize, type_name);
+  std::mt19937_64 rng(testSize);
+  std::vector<T> values(testSize);
+  for (auto &v : values) {
+    if constexpr (std::is_floating_point_v<T>) {
+      // both signs, several orders of magnitude
+      v = std::ldexp(static_cast<T>(rng()) / static_cast<T>(rng.max()) - 0.5,
+                     static_cast<int>(rng() % 64));
+    } else {
+      v = static_cast<T>(rng());
+    }
   }
 
   // time how long it takes to sort them:
-  for (int i = 0; i < iterationCount; ++i) {
-    std::vector<double> sorted(doubles);
-    const auto startTime = std::chrono::high_resolution_clock::now();
-    std::sort(std::execution::seq, sorted.begin(), sorted.end());
-    const auto endTime = std::chrono::high_resolution_clock::now();
-    print_results("Serial STL ", sorted, startTime, endTime);
+  if (comparison_sorts) {
+    benchmark("Serial STL         ", values, [](std::vector<T> &v) {
+      std::sort(std::execution::seq, v.begin(), v.end());
+    });
   }
 
-  for (int i = 0; i < iterationCount; ++i) {
-    std::vector<double> sorted(doubles);
-    const auto startTime = std::chrono::high_resolution_clock::now();
-    // same sort call as above, but with par_unseq:
-    std::sort(std::execution::par, sorted.begin(), sorted.end());
-    const auto endTime = std::chrono::high_resolution_clock::now();
-    // in our output, note that these are the parallel results:
-    print_results("Parallel STL", sorted, startTime, endTime);
+  // same sort call as above, but with par:
+  benchmark("Parallel STL       ", values, [](std::vector<T> &v) {
+    std::sort(std::execution::par, v.begin(), v.end());
+  });
+
+  // our own parallel quicksort, running on the thread pool:
+  if (comparison_sorts) {
+    benchmark("parallel_sort      ", values, [&pool](std::vector<T> &v) {
+      parallel_sort(pool, v.begin(), v.end());
+    });
+  }
+
+  // our own radix sort, running on the thread pool:
+  benchmark("parallel_radix_sort", values, [&pool](std::vector<T> &v) {
+    parallel_radix_sort(pool, v.begin(), v.end());
+  });
+}
+
+int main(int argc, char **argv) {
+  const size_t maxSize = argc > 1 ? std::stoul(argv[1]) : maxTestSize;
+  thread_pool pool;
+
+  for (size_t testSize = 1'000'000; testSize <= maxSize; testSize *= 10) {
+    benchmark_all<double>(pool, "doubles", testSize, true);
+    benchmark_all<std::uint32_t>(pool, "uint32", testSize, false);
+    benchmark_all<std::uint64_t>(pool, "uint64", testSize, false);
+    benchmark_all<std::int64_t>(pool, "int64", testSize, false);
   }
 }
@@ -70,10 +70,8 @@ int main() {
   for (int i = 0; i < iterationCount; ++i) {
     std::list<double> sorted(doubles);
     const auto startTime = std::chrono::high_resolution_clock::now();
-    // same sort call as above, but with par_unseq:
-    parallel_quick_sort(doubles);
+    sorted = parallel_quick_sort(std::move(sorted));
     const auto endTime = std::chrono::high_resolution_clock::now();
-    // in our output, note that these are the parallel results:
-    print_results("Parallel STL", sorted, startTime, endTime);
+    print_results("parallel_quick_sort", sorted, startTime, endTime);
   }
 }
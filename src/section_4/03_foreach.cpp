@@ -8,6 +8,9 @@
 #include <thread>
 #include <vector>
 
+#include "parallel_for.h"
+#include "section_8/thread_pool.h"
+
 using std::milli;
 using std::chrono::duration;
 using std::chrono::duration_cast;
@@ -68,7 +71,7 @@ void parallel_for_each_pt(Iterator first, Iterator last, Func f) {
 
   // Partition the data
   Iterator block_start = first;
-  for (unsigned long i = 0; i <= (num_threads - 2); i++) {
+  for (unsigned long i = 0; i + 1 < num_threads; i++) {
     Iterator block_end = block_start;
     std::advance(block_end, block_size);
 
@@ -123,43 +126,82 @@ void parallel_for_each_async(Iterator first, Iterator last, Func f) {
 
 const size_t testSize = 1000;
 
-int main() {
-  std::vector<int> ints(testSize);
-  for (auto &i : ints) {
-    i = 1;
+// Busy work the optimizer cannot remove.
+void burn(int iterations) {
+  volatile int sum = 0;
+  for (auto i = 0; i < iterations; i++) {
+    sum = sum + 1 * (i - 499);
   }
+}
 
-  auto long_function = [](const int &n) {
-    int sum = 0;
-    for (auto i = 0; i < 100000; i++) {
-      sum += 1 * (i - 499);
-    }
-  };
+// Runs every for_each version over ints, using f as the per-element work.
+template <typename Func>
+void benchmark(const char *const workload, thread_pool &pool,
+               std::vector<int> const &ints, Func f) {
+  printf("\n%s workload:\n", workload);
 
   auto startTime = high_resolution_clock::now();
-  std::for_each(ints.cbegin(), ints.cend(), long_function);
+  std::for_each(ints.cbegin(), ints.cend(), f);
   auto endTime = high_resolution_clock::now();
   print_results("STL                   ", startTime, endTime);
 
   startTime = high_resolution_clock::now();
-  for_each(std::execution::seq, ints.cbegin(), ints.cend(), long_function);
+  for_each(std::execution::seq, ints.cbegin(), ints.cend(), f);
   endTime = high_resolution_clock::now();
   print_results("STL-seq               ", startTime, endTime);
 
   startTime = high_resolution_clock::now();
-  std::for_each(std::execution::par, ints.cbegin(), ints.cend(), long_function);
+  std::for_each(std::execution::par, ints.cbegin(), ints.cend(), f);
   endTime = high_resolution_clock::now();
   print_results("STL-par               ", startTime, endTime);
 
   startTime = high_resolution_clock::now();
-  parallel_for_each_pt(ints.cbegin(), ints.cend(), long_function);
+  parallel_for_each_pt(ints.cbegin(), ints.cend(), f);
   endTime = high_resolution_clock::now();
   print_results("Parallel-package_task ", startTime, endTime);
 
   startTime = high_resolution_clock::now();
-  parallel_for_each_async(ints.cbegin(), ints.cend(), long_function);
+  parallel_for_each_async(ints.cbegin(), ints.cend(), f);
   endTime = high_resolution_clock::now();
   print_results("Parallel-async        ", startTime, endTime);
 
+  const std::pair<schedule, const char *> schedules[] = {
+      {schedule::static_blocks, "Pool-static           "},
+      {schedule::dynamic, "Pool-dynamic          "},
+      {schedule::guided, "Pool-guided           "},
+      {schedule::lazy_splitting, "Pool-lazy_splitting   "},
+  };
+  for (auto const &[kind, tag] : schedules) {
+    startTime = high_resolution_clock::now();
+    parallel_for_each(pool, ints.cbegin(), ints.cend(), f, kind);
+    endTime = high_resolution_clock::now();
+    print_results(tag, startTime, endTime);
+  }
+}
+
+int main() {
+  std::vector<int> ints(testSize);
+  for (size_t i = 0; i < testSize; i++) {
+    ints[i] = i;
+  }
+
+  thread_pool pool;
+
+  // every element costs the same.
+  benchmark("Uniform", pool, ints, [](const int &) { burn(100000); });
+
+  // cost grows with the index: the last block is the most expensive one.
+  benchmark("Increasing", pool, ints,
+            [](const int &n) { burn(200 * n); });
+
+  // 1% of the elements are 100 times more expensive.
+  benchmark("Spiky", pool, ints, [](const int &n) {
+    burn(n % 100 == 99 ? 1000000 : 10000);
+  });
+
+  // very cheap elements: scheduling overhead dominates.
+  std::vector<int> many_ints(testSize * 100, 1);
+  benchmark("Cheap", pool, many_ints, [](const int &) { burn(1); });
+
   return 0;
 }
@@ -5,6 +5,7 @@
 #include <future>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -14,6 +15,10 @@
 #include <thread>
 #include <vector>
 
+#include "parallel_find.h"
+#include "section_8/task_scope.h"
+#include "section_8/thread_pool.h"
+
 using std::milli;
 using std::chrono::duration;
 using std::chrono::duration_cast;
@@ -172,18 +177,77 @@ Iterator parallel_find_async(Iterator first, Iterator last, MatchType match) {
 }
 
 // ===================================================================
-// Benchmark
+// Implementation C: Task Scope Cancellation
 // ===================================================================
+// The range is split into more blocks than threads and every block is a
+// task of the same task_scope. The first match requests stop on the scope:
+// queued blocks are dropped without running, and running blocks check the
+// stop_token once per chunk instead of once per element.
+template <typename Iterator, typename MatchType>
+Iterator parallel_find_scoped(thread_pool &pool, Iterator first,
+                              Iterator last, MatchType match) {
+  unsigned long const length = std::distance(first, last);
 
-const size_t testSize = 1000;
+  if (!length) {
+    return last;
+  }
 
-using std::milli;
-using std::chrono::duration;
-using std::chrono::duration_cast;
-using std::chrono::high_resolution_clock;
+  unsigned long const min_per_block = 1024;
+  unsigned long const chunk_size = 256;
+  unsigned long const max_blocks =
+      (length + min_per_block - 1) / min_per_block;
+  unsigned long const num_blocks = std::min(pool.size() * 8, max_blocks);
+  unsigned long const block_size = length / num_blocks;
+
+  Iterator result = last;
+  std::atomic<bool> found(false);
+  task_scope scope(pool);
+
+  Iterator block_start = first;
+  for (unsigned long i = 0; i < num_blocks; i++) {
+    Iterator block_end = block_start;
+    if (i + 1 == num_blocks) {
+      block_end = last;
+    } else {
+      std::advance(block_end, block_size);
+    }
+
+    scope.spawn([=, &result, &found, &scope](std::stop_token token) {
+      Iterator it = block_start;
+      while (it != block_end) {
+        // Interrupt point, once per chunk.
+        if (token.stop_requested()) {
+          return;
+        }
+        for (unsigned long n = 0; n < chunk_size && it != block_end;
+             ++n, ++it) {
+          if (*it == match) {
+            if (!found.exchange(true)) {
+              result = it;
+            }
+            scope.request_stop();
+            return;
+          }
+        }
+      }
+    });
+
+    block_start = block_end;
+  }
 
-int main() {
+  scope.wait();
+  return result;
+}
+
+// ===================================================================
+// Benchmark
+// ===================================================================
+
+const size_t testSize = 1000;
+const size_t largeTestSize = 100'000'000;
 
+// Small example of every version.
+void small_example() {
   std::vector<int> ints(testSize);
   for (size_t i = 0; i < testSize; i++) {
     ints[i] = i;
@@ -201,6 +265,17 @@ int main() {
   endTime = high_resolution_clock::now();
   print_results("Parallel-divide-and-conquer-async :", startTime, endTime);
 
+  thread_pool pool;
+  startTime = high_resolution_clock::now();
+  parallel_find_scoped(pool, ints.begin(), ints.end(), looking_for);
+  endTime = high_resolution_clock::now();
+  print_results("Parallel-task_scope :", startTime, endTime);
+
+  startTime = high_resolution_clock::now();
+  parallel_find(pool, ints.begin(), ints.end(), looking_for);
+  endTime = high_resolution_clock::now();
+  print_results("Parallel-simd_leftmost :", startTime, endTime);
+
   startTime = high_resolution_clock::now();
   std::find(ints.begin(), ints.end(), looking_for);
   endTime = high_resolution_clock::now();
@@ -215,6 +290,60 @@ int main() {
   std::find(std::execution::seq, ints.begin(), ints.end(), looking_for);
   endTime = high_resolution_clock::now();
   print_results("STL parallel-seq :", startTime, endTime);
+}
+
+// Times find_function and checks it returns the expected position.
+template <typename FindFunction>
+void benchmark(const char *const tag, std::vector<int> const &ints,
+               size_t expected, FindFunction find_function) {
+  auto startTime = high_resolution_clock::now();
+  auto const it = find_function(ints.begin(), ints.end());
+  auto endTime = high_resolution_clock::now();
+  size_t const position = it - ints.begin();
+  printf("%s: Time: %fms %s\n", tag,
+         duration_cast<duration<double, milli>>(endTime - startTime).count(),
+         position == expected ? "" : "(not the leftmost match)");
+}
+
+// Large vectors, with the match at the start, middle, end, or absent.
+void large_benchmark(size_t size) {
+  thread_pool pool;
+  std::vector<int> ints(size, 0);
+  const int looking_for = 1;
+
+  const std::pair<const char *, size_t> cases[] = {
+      {"start", 100}, {"middle", size / 2}, {"end", size - 1}, {"absent", size}};
+
+  for (auto const &[name, position] : cases) {
+    printf("\nMatch at %s of %zu ints:\n", name, size);
+    if (position < size) {
+      ints[position] = looking_for;
+      // a second match further right: only the first one is expected.
+      ints[std::min(size - 1, position + size / 4)] = looking_for;
+    }
+
+    benchmark("STL sequential         ", ints, position, [&](auto f, auto l) {
+      return std::find(f, l, looking_for);
+    });
+    benchmark("STL parallel-par       ", ints, position, [&](auto f, auto l) {
+      return std::find(std::execution::par, f, l, looking_for);
+    });
+    benchmark("Parallel-promise_atomic", ints, position, [&](auto f, auto l) {
+      return parallel_find_promise(f, l, looking_for);
+    });
+    benchmark("Parallel-task_scope    ", ints, position, [&](auto f, auto l) {
+      return parallel_find_scoped(pool, f, l, looking_for);
+    });
+    benchmark("Parallel-simd_leftmost ", ints, position, [&](auto f, auto l) {
+      return parallel_find(pool, f, l, looking_for);
+    });
+
+    std::fill(ints.begin(), ints.end(), 0);
+  }
+}
 
+int main(int argc, char **argv) {
+  small_example();
+  large_benchmark(argc > 1 ? std::stoul(argv[1]) : largeTestSize);
   return 0;
 }
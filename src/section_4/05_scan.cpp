@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <execution>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "parallel_scan.h"
+#include "section_8/thread_pool.h"
+
+using std::milli;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results
+void print_results(const char *const tag, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  printf("%s: Time: %fms %s\n", tag,
+         duration_cast<duration<double, milli>>(endTime - startTime).count(),
+         correct ? "" : "WRONG RESULT");
+}
+
+// ===================================================================
+// Example: Stream compaction
+// ===================================================================
+// The exclusive scan of the keep flags gives the output position of every
+// kept element, so all of them can be written in parallel.
+std::vector<int> parallel_copy_if_even(thread_pool &pool,
+                                       std::vector<int> const &input) {
+  std::vector<std::size_t> offsets(input.size());
+  parallel_transform_inclusive_scan(
+      pool, input.begin(), input.end(), offsets.begin(), std::plus<>(),
+      [](int x) -> std::size_t { return x % 2 == 0; });
+
+  std::vector<int> output(input.empty() ? 0 : offsets.back());
+  pool.fork_join(pool.size() + 1, [&](std::size_t t) {
+    std::size_t const begin = t * input.size() / (pool.size() + 1);
+    std::size_t const end = (t + 1) * input.size() / (pool.size() + 1);
+    for (std::size_t i = begin; i < end; ++i) {
+      if (input[i] % 2 == 0) {
+        output[offsets[i] - 1] = input[i]; // inclusive: position + 1
+      }
+    }
+  });
+  return output;
+}
+
+void compaction_example(thread_pool &pool) {
+  std::vector<int> input(20);
+  std::iota(input.begin(), input.end(), 0);
+  std::vector<int> const even = parallel_copy_if_even(pool, input);
+  printf("even numbers:");
+  for (int x : even) {
+    printf(" %d", x);
+  }
+  printf("\n");
+}
+
+// ===================================================================
+// Benchmark
+// ===================================================================
+const size_t maxTestSize = 100'000'000;
+
+void benchmark(thread_pool &pool, size_t testSize) {
+  printf("\nScanning %zu int64...\n", testSize);
+  std::mt19937_64 rng(testSize);
+  std::vector<std::int64_t> input(testSize);
+  for (auto &x : input) {
+    x = static_cast<std::int64_t>(rng() % 1000);
+  }
+
+  std::vector<std::int64_t> expected(testSize);
+  std::vector<std::int64_t> expected_exclusive(testSize);
+  std::vector<std::int64_t> output(testSize);
+
+  auto startTime = high_resolution_clock::now();
+  std::inclusive_scan(std::execution::seq, input.begin(), input.end(),
+                      expected.begin());
+  auto endTime = high_resolution_clock::now();
+  print_results("STL inclusive_scan seq          ", true, startTime,
+                endTime);
+
+  startTime = high_resolution_clock::now();
+  std::inclusive_scan(std::execution::par, input.begin(), input.end(),
+                      output.begin());
+  endTime = high_resolution_clock::now();
+  print_results("STL inclusive_scan par          ", output == expected,
+                startTime, endTime);
+
+  startTime = high_resolution_clock::now();
+  parallel_inclusive_scan(pool, input.begin(), input.end(), output.begin());
+  endTime = high_resolution_clock::now();
+  print_results("parallel_inclusive_scan         ", output == expected,
+                startTime, endTime);
+
+  std::exclusive_scan(input.begin(), input.end(), expected_exclusive.begin(),
+                      std::int64_t(0));
+
+  startTime = high_resolution_clock::now();
+  std::exclusive_scan(std::execution::par, input.begin(), input.end(),
+                      output.begin(), std::int64_t(0));
+  endTime = high_resolution_clock::now();
+  print_results("STL exclusive_scan par          ",
+                output == expected_exclusive, startTime, endTime);
+
+  startTime = high_resolution_clock::now();
+  parallel_exclusive_scan(pool, input.begin(), input.end(), output.begin(),
+                          std::int64_t(0));
+  endTime = high_resolution_clock::now();
+  print_results("parallel_exclusive_scan         ",
+                output == expected_exclusive, startTime, endTime);
+
+  // x -> 2x, then prefix sum: twice the plain prefix sum.
+  startTime = high_resolution_clock::now();
+  parallel_transform_inclusive_scan(pool, input.begin(), input.end(),
+                                    output.begin(), std::plus<>(),
+                                    [](std::int64_t x) { return 2 * x; });
+  endTime = high_resolution_clock::now();
+  bool correct = true;
+  for (size_t i = 0; i < testSize && correct; ++i) {
+    correct = output[i] == 2 * expected[i];
+  }
+  print_results("parallel_transform_inclusive_scan", correct, startTime,
+                endTime);
+
+  output = input;
+  startTime = high_resolution_clock::now();
+  parallel_inclusive_scan_inplace(pool, output.begin(), output.end());
+  endTime = high_resolution_clock::now();
+  print_results("parallel_inclusive_scan_inplace ", output == expected,
+                startTime, endTime);
+}
+
+int main(int argc, char **argv) {
+  const size_t maxSize = argc > 1 ? std::stoul(argv[1]) : maxTestSize;
+  thread_pool pool;
+
+  compaction_example(pool);
+  for (size_t testSize = 1'000'000; testSize <= maxSize; testSize *= 10) {
+    benchmark(pool, testSize);
+  }
+  return 0;
+}
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <execution>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "parallel_reduce.h"
+#include "section_8/thread_pool.h"
+
+using std::milli;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results
+void print_results(const char *const tag, double result, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  printf("%s: Result: %g Time: %fms %s\n", tag, result,
+         duration_cast<duration<double, milli>>(endTime - startTime).count(),
+         correct ? "" : "WRONG RESULT");
+}
+
+// Floating point sums depend on the order of the additions. The rounding
+// errors are relative to the magnitude of the terms (scale), not to the
+// result, which can be small when the terms cancel out.
+bool close_to(double a, double b, double scale) {
+  return std::abs(a - b) <= 1e-9 * scale;
+}
+
+// ===================================================================
+// State objects
+// ===================================================================
+// Summary statistics, updated in place by every block.
+struct stats {
+  std::size_t count = 0;
+  double sum = 0;
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+
+  void add(double x) {
+    ++count;
+    sum += x;
+    min = std::min(min, x);
+    max = std::max(max, x);
+  }
+
+  void merge(stats const &other) {
+    count += other.count;
+    sum += other.sum;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+  }
+
+  double mean() const { return count ? sum / count : 0; }
+};
+
+// Fixed size histogram of values in [-4, 4): a plain array, no allocation.
+struct histogram {
+  static constexpr std::size_t num_buckets = 64;
+  static constexpr double low = -4, high = 4;
+  std::array<std::size_t, num_buckets> buckets{};
+
+  void add(double x) {
+    double const position = (x - low) / (high - low) * num_buckets;
+    std::size_t const bucket = static_cast<std::size_t>(
+        std::clamp(position, 0.0, double(num_buckets - 1)));
+    ++buckets[bucket];
+  }
+
+  void merge(histogram const &other) {
+    for (std::size_t i = 0; i < num_buckets; ++i) {
+      buckets[i] += other.buckets[i];
+    }
+  }
+
+  bool operator==(histogram const &) const = default;
+};
+
+// ===================================================================
+// Benchmark
+// ===================================================================
+const size_t maxTestSize = 100'000'000;
+
+void benchmark(thread_pool &pool, size_t testSize) {
+  printf("\nReducing %zu doubles...\n", testSize);
+  std::mt19937_64 rng(testSize);
+  std::normal_distribution<double> normal;
+  std::vector<double> a(testSize);
+  std::vector<double> b(testSize);
+  for (size_t i = 0; i < testSize; ++i) {
+    a[i] = normal(rng);
+    b[i] = normal(rng);
+  }
+
+  // sum of squares
+  auto square = [](double x) { return x * x; };
+  auto startTime = high_resolution_clock::now();
+  double const expected = std::transform_reduce(
+      std::execution::seq, a.begin(), a.end(), 0.0, std::plus<>(), square);
+  auto endTime = high_resolution_clock::now();
+  print_results("STL transform_reduce seq  ", expected, true, startTime,
+                endTime);
+
+  startTime = high_resolution_clock::now();
+  double result = std::transform_reduce(std::execution::par, a.begin(),
+                                        a.end(), 0.0, std::plus<>(), square);
+  endTime = high_resolution_clock::now();
+  print_results("STL transform_reduce par  ", result,
+                close_to(result, expected, expected), startTime, endTime);
+
+  startTime = high_resolution_clock::now();
+  result = parallel_transform_reduce(pool, a.begin(), a.end(), 0.0,
+                                     std::plus<>(), square);
+  endTime = high_resolution_clock::now();
+  print_results("parallel_transform_reduce ", result,
+                close_to(result, expected, expected), startTime, endTime);
+
+  // dot product
+  double const expected_dot =
+      std::transform_reduce(a.begin(), a.end(), b.begin(), 0.0);
+  startTime = high_resolution_clock::now();
+  result = parallel_transform_reduce(pool, a.begin(), a.end(), b.begin(), 0.0);
+  endTime = high_resolution_clock::now();
+  print_results("parallel dot product      ", result,
+                close_to(result, expected_dot, expected), startTime, endTime);
+
+  // summary statistics
+  stats expected_stats;
+  for (double x : a) {
+    expected_stats.add(x);
+  }
+  startTime = high_resolution_clock::now();
+  stats const s = parallel_map_reduce(
+      pool, a.begin(), a.end(), stats(),
+      [](stats &state, double x) { state.add(x); },
+      [](stats &state, stats &&other) { state.merge(other); });
+  endTime = high_resolution_clock::now();
+  print_results("parallel stats (mean)     ", s.mean(),
+                s.count == expected_stats.count &&
+                    s.min == expected_stats.min &&
+                    s.max == expected_stats.max &&
+                    close_to(s.sum, expected_stats.sum, testSize),
+                startTime, endTime);
+  printf("  count: %zu min: %f max: %f mean: %f\n", s.count, s.min, s.max,
+         s.mean());
+
+  // histogram
+  histogram expected_histogram;
+  startTime = high_resolution_clock::now();
+  for (double x : a) {
+    expected_histogram.add(x);
+  }
+  endTime = high_resolution_clock::now();
+  print_results("sequential histogram      ", 0, true, startTime, endTime);
+
+  startTime = high_resolution_clock::now();
+  histogram const h = parallel_map_reduce(
+      pool, a.begin(), a.end(), histogram(),
+      [](histogram &state, double x) { state.add(x); },
+      [](histogram &state, histogram &&other) { state.merge(other); });
+  endTime = high_resolution_clock::now();
+  print_results("parallel histogram        ", 0, h == expected_histogram,
+                startTime, endTime);
+}
+
+int main(int argc, char **argv) {
+  const size_t maxSize = argc > 1 ? std::stoul(argv[1]) : maxTestSize;
+  thread_pool pool;
+
+  for (size_t testSize = 1'000'000; testSize <= maxSize; testSize *= 10) {
+    benchmark(pool, testSize);
+  }
+  return 0;
+}
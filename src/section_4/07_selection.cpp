@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <execution>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "parallel_partition.h"
+#include "parallel_selection.h"
+#include "section_8/thread_pool.h"
+
+using std::milli;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results
+void print_results(const char *const tag, double result, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  printf("%s: Result: %g Time: %fms %s\n", tag, result,
+         duration_cast<duration<double, milli>>(endTime - startTime).count(),
+         correct ? "" : "WRONG RESULT");
+}
+
+// ===================================================================
+// Benchmark
+// ===================================================================
+const size_t maxTestSize = 100'000'000;
+const size_t k = 1000;
+
+void benchmark(thread_pool &pool, size_t testSize) {
+  printf("\nSelecting from %zu doubles...\n", testSize);
+  std::mt19937_64 rng(testSize);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::vector<double> values(testSize);
+  for (auto &v : values) {
+    v = uniform(rng);
+  }
+  std::vector<double> work(values);
+
+  // partition: elements below 0.3 first
+  auto below = [](double x) { return x < 0.3; };
+  auto startTime = high_resolution_clock::now();
+  auto const expected_cut = std::partition(work.begin(), work.end(), below);
+  auto endTime = high_resolution_clock::now();
+  std::size_t const expected_count = expected_cut - work.begin();
+  print_results("STL partition          ", expected_count, true, startTime,
+                endTime);
+
+  work = values;
+  startTime = high_resolution_clock::now();
+  auto const cut = parallel_partition(pool, work.begin(), work.end(), below);
+  endTime = high_resolution_clock::now();
+  std::size_t const count = cut - work.begin();
+  print_results("parallel_partition     ", count,
+                count == expected_count &&
+                    std::is_partitioned(work.begin(), work.end(), below),
+                startTime, endTime);
+
+  // percentiles
+  for (double const percentile : {0.5, 0.99}) {
+    std::size_t const n = static_cast<std::size_t>(percentile * testSize);
+    printf("p%g:\n", percentile * 100);
+
+    work = values;
+    startTime = high_resolution_clock::now();
+    std::nth_element(work.begin(), work.begin() + n, work.end());
+    endTime = high_resolution_clock::now();
+    double const expected = work[n];
+    print_results("STL nth_element        ", expected, true, startTime,
+                  endTime);
+
+    work = values;
+    startTime = high_resolution_clock::now();
+    std::nth_element(std::execution::par, work.begin(), work.begin() + n,
+                     work.end());
+    endTime = high_resolution_clock::now();
+    print_results("STL nth_element par    ", work[n], work[n] == expected,
+                  startTime, endTime);
+
+    work = values;
+    startTime = high_resolution_clock::now();
+    parallel_nth_element(pool, work.begin(), work.begin() + n, work.end());
+    endTime = high_resolution_clock::now();
+    bool const correct =
+        work[n] == expected &&
+        std::all_of(work.begin(), work.begin() + n,
+                    [&](double x) { return x <= expected; }) &&
+        std::all_of(work.begin() + n, work.end(),
+                    [&](double x) { return x >= expected; });
+    print_results("parallel_nth_element   ", work[n], correct, startTime,
+                  endTime);
+  }
+
+  // top-k: the k largest values
+  printf("top %zu:\n", k);
+  work = values;
+  startTime = high_resolution_clock::now();
+  std::partial_sort(work.begin(), work.begin() + k, work.end(),
+                    std::greater<>());
+  endTime = high_resolution_clock::now();
+  std::vector<double> const expected_top(work.begin(), work.begin() + k);
+  print_results("STL partial_sort       ", expected_top.back(), true,
+                startTime, endTime);
+
+  work = values;
+  startTime = high_resolution_clock::now();
+  parallel_partial_sort(pool, work.begin(), work.begin() + k, work.end(),
+                        std::greater<>());
+  endTime = high_resolution_clock::now();
+  print_results("parallel_partial_sort  ", work[k - 1],
+                std::equal(expected_top.begin(), expected_top.end(),
+                           work.begin()),
+                startTime, endTime);
+
+  startTime = high_resolution_clock::now();
+  std::vector<double> const top =
+      parallel_top_k(pool, values.begin(), values.end(), k);
+  endTime = high_resolution_clock::now();
+  print_results("parallel_top_k         ", top.back(), top == expected_top,
+                startTime, endTime);
+}
+
+int main(int argc, char **argv) {
+  const size_t maxSize = argc > 1 ? std::stoul(argv[1]) : maxTestSize;
+  thread_pool pool;
+
+  for (size_t testSize = 1'000'000; testSize <= maxSize; testSize *= 10) {
+    benchmark(pool, testSize);
+  }
+  return 0;
+}
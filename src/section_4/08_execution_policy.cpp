@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "execution_policy.h"
+#include "parallel_find.h"
+#include "parallel_for.h"
+#include "parallel_reduce.h"
+#include "parallel_scan.h"
+#include "parallel_sort.h"
+#include "section_8/thread_pool.h"
+
+using std::milli;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results
+void print_results(const char *const tag, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  printf("%s: Time: %fms %s\n", tag,
+         duration_cast<duration<double, milli>>(endTime - startTime).count(),
+         correct ? "" : "WRONG RESULT");
+}
+
+// Busy work for one element.
+std::uint64_t burn(std::uint64_t x, int rounds) {
+  volatile std::uint64_t v = x;
+  for (int i = 0; i < rounds; ++i) {
+    v = v * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  return v;
+}
+
+// ===================================================================
+// Example: one policy, every algorithm
+// ===================================================================
+// Every algorithm of this section runs on the policy's pool: no other
+// threads are created.
+void all_algorithms(execution_policy const &policy, size_t size) {
+  printf("\nAll algorithms on one pool (%zu elements):\n", size);
+  std::vector<std::int64_t> values(size);
+  std::iota(values.begin(), values.end(), 0);
+
+  auto startTime = high_resolution_clock::now();
+  std::int64_t const sum =
+      parallel_accumulate(policy, values.begin(), values.end(),
+                          std::int64_t(0));
+  auto endTime = high_resolution_clock::now();
+  std::int64_t const n = size;
+  print_results("parallel_accumulate", sum == n * (n - 1) / 2, startTime,
+                endTime);
+
+  startTime = high_resolution_clock::now();
+  parallel_for_each(policy, values.begin(), values.end(),
+                    [](std::int64_t &x) { x = x * 7 % 1000; });
+  endTime = high_resolution_clock::now();
+  print_results("parallel_for_each  ", values[size - 1] == (n - 1) * 7 % 1000,
+                startTime, endTime);
+
+  startTime = high_resolution_clock::now();
+  auto const found =
+      parallel_find(policy, values.begin(), values.end(), std::int64_t(999));
+  endTime = high_resolution_clock::now();
+  print_results("parallel_find      ",
+                found == std::find(values.begin(), values.end(), 999),
+                startTime, endTime);
+
+  std::vector<std::int64_t> sums(size);
+  startTime = high_resolution_clock::now();
+  parallel_inclusive_scan(policy, values.begin(), values.end(),
+                          sums.begin());
+  endTime = high_resolution_clock::now();
+  std::vector<std::int64_t> expected(size);
+  std::inclusive_scan(values.begin(), values.end(), expected.begin());
+  print_results("parallel_scan      ", sums == expected, startTime, endTime);
+
+  startTime = high_resolution_clock::now();
+  parallel_sort(policy, values.begin(), values.end());
+  endTime = high_resolution_clock::now();
+  print_results("parallel_sort      ",
+                std::is_sorted(values.begin(), values.end()), startTime,
+                endTime);
+}
+
+// ===================================================================
+// Example: chunk size hint
+// ===================================================================
+// Small chunks balance uneven work better, large chunks cost less per
+// element. Every index i costs i rounds of burn: the work increases along
+// the range.
+void chunk_sizes(thread_pool &pool, size_t size) {
+  printf("\nChunk size hints (%zu elements, increasing work):\n", size);
+  std::vector<std::uint64_t> values(size);
+  for (std::size_t chunk_size : {16, 256, 4096, 65536}) {
+    execution_policy const policy(pool, chunk_size);
+    auto const startTime = high_resolution_clock::now();
+    parallel_for(
+        policy, 0, size,
+        [&](std::size_t i) {
+          values[i] = burn(i, static_cast<int>(i * 100 / size));
+        },
+        schedule::dynamic);
+    auto const endTime = high_resolution_clock::now();
+    std::string const tag = "chunk_size " + std::to_string(chunk_size);
+    print_results(tag.c_str(), true, startTime, endTime);
+  }
+
+  // tiny chunk sizes still leave small ranges to insertion sort.
+  std::vector<int> ints(1000);
+  std::mt19937 gen(1);
+  for (std::size_t chunk_size : {1, 2, 3}) {
+    bool sorted = true;
+    for (int round = 0; round < 20; ++round) {
+      std::generate(ints.begin(), ints.end(),
+                    [&] { return static_cast<int>(gen()); });
+      parallel_sort(execution_policy(pool, chunk_size), ints.begin(),
+                    ints.end());
+      sorted &= std::is_sorted(ints.begin(), ints.end());
+    }
+    printf("parallel_sort, chunk_size %zu: sorted: %s\n", chunk_size,
+           sorted ? "yes" : "no");
+  }
+}
+
+// ===================================================================
+// Example: cancellation
+// ===================================================================
+// Another thread requests stop after a deadline: the algorithms stop
+// starting new chunks and return early.
+void cancellation(thread_pool &pool, size_t size) {
+  printf("\nCancellation after 20ms:\n");
+  for (schedule kind : {schedule::static_blocks, schedule::dynamic,
+                        schedule::guided, schedule::lazy_splitting}) {
+    std::stop_source source;
+    execution_policy const policy(pool, 0, source.get_token());
+    std::jthread canceller([&source] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      source.request_stop();
+    });
+
+    std::atomic<std::size_t> done{0};
+    auto const startTime = high_resolution_clock::now();
+    parallel_for(
+        policy, 0, size,
+        [&](std::size_t i) {
+          burn(i, 1000);
+          done.fetch_add(1, std::memory_order_relaxed);
+        },
+        kind);
+    auto const endTime = high_resolution_clock::now();
+    printf("schedule %d: processed %zu of %zu elements in %fms\n",
+           static_cast<int>(kind), done.load(), size,
+           duration_cast<duration<double, milli>>(endTime - startTime)
+               .count());
+  }
+
+  // a sort stopped halfway leaves the range partially sorted.
+  std::vector<std::uint64_t> values(size * 10);
+  std::mt19937_64 rng(size);
+  for (auto &v : values) {
+    v = rng();
+  }
+  std::stop_source source;
+  source.request_stop();
+  execution_policy const stopped(pool, 0, source.get_token());
+  parallel_sort(stopped, values.begin(), values.end());
+  printf("parallel_sort already stopped: sorted: %s\n",
+         std::is_sorted(values.begin(), values.end()) ? "yes" : "no");
+  parallel_sort(pool, values.begin(), values.end());
+  printf("parallel_sort: sorted: %s\n",
+         std::is_sorted(values.begin(), values.end()) ? "yes" : "no");
+}
+
+int main(int argc, char **argv) {
+  const size_t size = argc > 1 ? std::stoul(argv[1]) : 10'000'000;
+  thread_pool pool;
+  execution_policy const policy(pool);
+
+  all_algorithms(policy, size);
+  chunk_sizes(pool, size / 10);
+  cancellation(pool, size / 10);
+  return 0;
+}
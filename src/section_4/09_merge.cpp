@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <execution>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution_policy.h"
+#include "parallel_merge.h"
+#include "section_8/thread_pool.h"
+
+using std::milli;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+
+using iterator = std::vector<std::uint64_t>::const_iterator;
+using run_list = std::vector<std::pair<iterator, iterator>>;
+
+// Prints benchmark results
+void print_results(const char *const tag, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  printf("%s: Time: %fms %s\n", tag,
+         duration_cast<duration<double, milli>>(endTime - startTime).count(),
+         correct ? "" : "WRONG RESULT");
+}
+
+// num_runs sorted runs, stored one after the other in a single vector.
+std::vector<std::uint64_t> make_runs(size_t size, size_t num_runs) {
+  std::mt19937_64 rng(size + num_runs);
+  std::vector<std::uint64_t> values(size);
+  for (size_t r = 0; r < num_runs; ++r) {
+    std::uint64_t value = 0;
+    for (size_t i = r * size / num_runs; i < (r + 1) * size / num_runs; ++i) {
+      value += rng() % 1024; // increasing, with duplicates
+      values[i] = value;
+    }
+  }
+  return values;
+}
+
+run_list split_runs(std::vector<std::uint64_t> const &values,
+                    size_t num_runs) {
+  run_list runs;
+  for (size_t r = 0; r < num_runs; ++r) {
+    runs.emplace_back(values.begin() + r * values.size() / num_runs,
+                      values.begin() + (r + 1) * values.size() / num_runs);
+  }
+  return runs;
+}
+
+// Sequential k-way merge with a binary heap, for comparison.
+void heap_merge(run_list runs, std::vector<std::uint64_t>::iterator out) {
+  using entry = std::pair<std::uint64_t, size_t>; // value, run
+  std::priority_queue<entry, std::vector<entry>, std::greater<>> heap;
+  for (size_t r = 0; r < runs.size(); ++r) {
+    if (runs[r].first != runs[r].second) {
+      heap.emplace(*runs[r].first, r);
+    }
+  }
+  while (!heap.empty()) {
+    size_t const r = heap.top().second;
+    heap.pop();
+    *out++ = *runs[r].first++;
+    if (runs[r].first != runs[r].second) {
+      heap.emplace(*runs[r].first, r);
+    }
+  }
+}
+
+// ===================================================================
+// Benchmarks
+// ===================================================================
+const size_t maxTestSize = 100'000'000;
+
+void two_way(thread_pool &pool, size_t size) {
+  printf("\nMerging 2 runs, %zu elements...\n", size);
+  std::vector<std::uint64_t> const values = make_runs(size, 2);
+  auto const middle = values.begin() + size / 2;
+  std::vector<std::uint64_t> expected(size);
+  std::vector<std::uint64_t> output(size);
+
+  auto startTime = high_resolution_clock::now();
+  std::merge(values.begin(), middle, middle, values.end(), expected.begin());
+  auto endTime = high_resolution_clock::now();
+  print_results("STL merge seq          ", true, startTime, endTime);
+
+  startTime = high_resolution_clock::now();
+  std::merge(std::execution::par, values.begin(), middle, middle,
+             values.end(), output.begin());
+  endTime = high_resolution_clock::now();
+  print_results("STL merge par          ", output == expected, startTime,
+                endTime);
+
+  std::fill(output.begin(), output.end(), 0);
+  startTime = high_resolution_clock::now();
+  parallel_merge(pool, values.begin(), middle, middle, values.end(),
+                 output.begin());
+  endTime = high_resolution_clock::now();
+  print_results("parallel_merge         ", output == expected, startTime,
+                endTime);
+
+  std::fill(output.begin(), output.end(), 0);
+  startTime = high_resolution_clock::now();
+  parallel_multiway_merge(pool, split_runs(values, 2), output.begin());
+  endTime = high_resolution_clock::now();
+  print_results("parallel_multiway_merge", output == expected, startTime,
+                endTime);
+}
+
+void k_way(thread_pool &pool, size_t size, size_t num_runs) {
+  printf("\nMerging %zu runs, %zu elements...\n", num_runs, size);
+  std::vector<std::uint64_t> const values = make_runs(size, num_runs);
+  run_list const runs = split_runs(values, num_runs);
+  std::vector<std::uint64_t> expected(size);
+  std::vector<std::uint64_t> output(size);
+
+  auto startTime = high_resolution_clock::now();
+  heap_merge(runs, expected.begin());
+  auto endTime = high_resolution_clock::now();
+  print_results("heap merge (sequential)      ", true, startTime, endTime);
+
+  // a single block: one loser tree on the calling thread.
+  startTime = high_resolution_clock::now();
+  parallel_multiway_merge(execution_policy(pool, size), runs,
+                          output.begin());
+  endTime = high_resolution_clock::now();
+  print_results("loser tree (sequential)      ", output == expected,
+                startTime, endTime);
+
+  std::fill(output.begin(), output.end(), 0);
+  startTime = high_resolution_clock::now();
+  parallel_multiway_merge(pool, runs, output.begin());
+  endTime = high_resolution_clock::now();
+  print_results("parallel_multiway_merge      ", output == expected,
+                startTime, endTime);
+}
+
+// Merge sort: sorted blocks, then a k-way merge.
+void stable_sort(thread_pool &pool, size_t size) {
+  printf("\nStable sorting %zu elements...\n", size);
+  std::mt19937_64 rng(size);
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> values(size);
+  for (size_t i = 0; i < size; ++i) {
+    values[i] = {static_cast<std::uint32_t>(rng() % 1000),
+                 static_cast<std::uint32_t>(i)};
+  }
+  // sorted by key only: the indices show the stability.
+  auto by_key = [](auto const &a, auto const &b) { return a.first < b.first; };
+
+  auto expected = values;
+  auto startTime = high_resolution_clock::now();
+  std::stable_sort(expected.begin(), expected.end(), by_key);
+  auto endTime = high_resolution_clock::now();
+  print_results("STL stable_sort seq ", true, startTime, endTime);
+
+  auto output = values;
+  startTime = high_resolution_clock::now();
+  std::stable_sort(std::execution::par, output.begin(), output.end(), by_key);
+  endTime = high_resolution_clock::now();
+  print_results("STL stable_sort par ", output == expected, startTime,
+                endTime);
+
+  output = values;
+  startTime = high_resolution_clock::now();
+  parallel_stable_sort(pool, output.begin(), output.end(), by_key);
+  endTime = high_resolution_clock::now();
+  print_results("parallel_stable_sort", output == expected, startTime,
+                endTime);
+}
+
+int main(int argc, char **argv) {
+  const size_t maxSize = argc > 1 ? std::stoul(argv[1]) : maxTestSize;
+  thread_pool pool;
+
+  for (size_t testSize = 1'000'000; testSize <= maxSize; testSize *= 10) {
+    two_way(pool, testSize);
+    k_way(pool, testSize, 64);
+    stable_sort(pool, testSize);
+  }
+  return 0;
+}
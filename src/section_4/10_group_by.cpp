@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <compare>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "execution_policy.h"
+#include "parallel_group_by.h"
+#include "section_8/thread_pool.h"
+
+using std::milli;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results
+void print_results(const char *const tag, std::size_t groups, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  printf("%s: Groups: %zu Time: %fms %s\n", tag, groups,
+         duration_cast<duration<double, milli>>(endTime - startTime).count(),
+         correct ? "" : "WRONG RESULT");
+}
+
+struct row {
+  std::uint64_t key;
+  std::int64_t value;
+};
+
+// Aggregated per key: SELECT key, SUM(value), COUNT(*) GROUP BY key
+struct aggregate {
+  std::int64_t sum = 0;
+  std::uint64_t count = 0;
+
+  auto operator<=>(aggregate const &) const = default;
+};
+
+using group_list = std::vector<std::pair<std::uint64_t, aggregate>>;
+
+// ===================================================================
+// Benchmark
+// ===================================================================
+const size_t maxTestSize = 100'000'000;
+
+void benchmark(thread_pool &pool, size_t size, size_t cardinality) {
+  printf("\nGrouping %zu rows by %zu distinct keys...\n", size, cardinality);
+  // keys are random 64 bit ids, not small consecutive integers (which
+  // std::hash, the identity, would spread perfectly).
+  std::mt19937_64 rng(size + cardinality);
+  std::vector<std::uint64_t> keys(cardinality);
+  for (auto &key : keys) {
+    key = rng();
+  }
+  std::vector<row> rows(size);
+  for (auto &r : rows) {
+    r.key = keys[rng() % cardinality];
+    r.value = static_cast<std::int64_t>(rng() % 1000);
+  }
+
+  // sequential: one std::unordered_map
+  auto startTime = high_resolution_clock::now();
+  std::unordered_map<std::uint64_t, aggregate> map;
+  for (auto const &r : rows) {
+    aggregate &a = map[r.key];
+    a.sum += r.value;
+    ++a.count;
+  }
+  auto endTime = high_resolution_clock::now();
+  print_results("sequential unordered_map", map.size(), true, startTime,
+                endTime);
+  group_list expected(map.begin(), map.end());
+  std::sort(expected.begin(), expected.end());
+  map = {};
+
+  startTime = high_resolution_clock::now();
+  group_list groups = parallel_group_by(
+      pool, rows.begin(), rows.end(), [](row const &r) { return r.key; },
+      aggregate(),
+      [](aggregate &a, row const &r) {
+        a.sum += r.value;
+        ++a.count;
+      },
+      [](aggregate &a, aggregate &&other) {
+        a.sum += other.sum;
+        a.count += other.count;
+      });
+  endTime = high_resolution_clock::now();
+  std::size_t const num_groups = groups.size();
+  std::sort(groups.begin(), groups.end()); // the groups come unordered
+  print_results("parallel_group_by       ", num_groups, groups == expected,
+                startTime, endTime);
+}
+
+int main(int argc, char **argv) {
+  const size_t maxSize = argc > 1 ? std::stoul(argv[1]) : maxTestSize;
+  thread_pool pool;
+
+  for (size_t testSize = 1'000'000; testSize <= maxSize; testSize *= 10) {
+    benchmark(pool, testSize, 1'000);        // low cardinality
+    benchmark(pool, testSize, testSize / 4); // high cardinality
+  }
+  return 0;
+}
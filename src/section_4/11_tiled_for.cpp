@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution_policy.h"
+#include "parallel_for.h"
+#include "parallel_for_tiled.h"
+#include "section_8/thread_pool.h"
+
+using std::milli;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results
+void print_results(const char *const tag, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  printf("%s: Time: %fms %s\n", tag,
+         duration_cast<duration<double, milli>>(endTime - startTime).count(),
+         correct ? "" : "WRONG RESULT");
+}
+
+// Row-major matrix of doubles, with small integer values: every sum below
+// is exact, whatever the order.
+std::vector<double> make_matrix(size_t size, size_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<double> values(size);
+  for (auto &v : values) {
+    v = static_cast<double>(rng() % 16);
+  }
+  return values;
+}
+
+// ===================================================================
+// Matrix multiply: C = A * B, n x n
+// ===================================================================
+// Row partitioning: every thread gets a band of rows of C, and streams
+// the whole of B for every row (i, k, j order).
+void matmul_rows(thread_pool &pool, size_t n, std::vector<double> const &a,
+                 std::vector<double> const &b, std::vector<double> &c) {
+  parallel_for(
+      pool, 0, n,
+      [&](size_t i) {
+        for (size_t k = 0; k < n; ++k) {
+          double const aik = a[i * n + k];
+          for (size_t j = 0; j < n; ++j) {
+            c[i * n + j] += aik * b[k * n + j];
+          }
+        }
+      },
+      schedule::static_blocks);
+}
+
+// Tiled: every tile of C is computed in steps of k, so the block of B it
+// reads (k step x tile columns) stays in cache for all the tile rows.
+void matmul_tiled(thread_pool &pool, size_t n, std::vector<double> const &a,
+                  std::vector<double> const &b, std::vector<double> &c) {
+  std::array<size_t, 2> const extent{n, n};
+  std::array<size_t, 2> const shape =
+      cache_tile_shape(extent, 3 * sizeof(double));
+  size_t const k_step = shape[0];
+  parallel_for_tiled(pool, extent, shape, [&](tile_range<2> const &tile) {
+    for (size_t k0 = 0; k0 < n; k0 += k_step) {
+      size_t const k1 = std::min(n, k0 + k_step);
+      for (size_t i = tile.begin[0]; i < tile.end[0]; ++i) {
+        for (size_t k = k0; k < k1; ++k) {
+          double const aik = a[i * n + k];
+          for (size_t j = tile.begin[1]; j < tile.end[1]; ++j) {
+            c[i * n + j] += aik * b[k * n + j];
+          }
+        }
+      }
+    }
+  });
+}
+
+void matmul(thread_pool &pool, size_t n) {
+  printf("\nMatrix multiply %zu x %zu...\n", n, n);
+  std::vector<double> const a = make_matrix(n * n, n);
+  std::vector<double> const b = make_matrix(n * n, n + 1);
+  std::vector<double> expected(n * n, 0.0);
+  std::vector<double> c(n * n, 0.0);
+
+  auto startTime = high_resolution_clock::now();
+  matmul_rows(pool, n, a, b, expected);
+  auto endTime = high_resolution_clock::now();
+  print_results("row partitioned", true, startTime, endTime);
+
+  startTime = high_resolution_clock::now();
+  matmul_tiled(pool, n, a, b, c);
+  endTime = high_resolution_clock::now();
+  print_results("tiled (Morton) ", c == expected, startTime, endTime);
+}
+
+// ===================================================================
+// 5-point stencil (2D Jacobi), n x n, boundary fixed
+// ===================================================================
+const size_t sweeps = 10;
+
+inline void stencil_row(size_t n, size_t i, size_t j0, size_t j1,
+                        std::vector<double> const &in,
+                        std::vector<double> &out) {
+  for (size_t j = j0; j < j1; ++j) {
+    out[i * n + j] = 0.25 * (in[(i - 1) * n + j] + in[(i + 1) * n + j] +
+                             in[i * n + j - 1] + in[i * n + j + 1]);
+  }
+}
+
+void stencil_2d(thread_pool &pool, size_t n) {
+  printf("\n5-point stencil %zu x %zu, %zu sweeps...\n", n, n, sweeps);
+  std::vector<double> const grid = make_matrix(n * n, n);
+
+  std::vector<double> in = grid;
+  std::vector<double> out = grid;
+  auto startTime = high_resolution_clock::now();
+  for (size_t s = 0; s < sweeps; ++s) {
+    parallel_for(
+        pool, 1, n - 1,
+        [&](size_t i) { stencil_row(n, i, 1, n - 1, in, out); },
+        schedule::static_blocks);
+    std::swap(in, out);
+  }
+  auto endTime = high_resolution_clock::now();
+  print_results("row partitioned", true, startTime, endTime);
+  std::vector<double> const expected = std::move(in);
+
+  in = grid;
+  out = grid;
+  std::array<size_t, 2> const interior{n - 2, n - 2};
+  std::array<size_t, 2> const shape =
+      cache_tile_shape(interior, 2 * sizeof(double));
+  startTime = high_resolution_clock::now();
+  for (size_t s = 0; s < sweeps; ++s) {
+    parallel_for_tiled(pool, interior, shape, [&](tile_range<2> const &t) {
+      for (size_t i = t.begin[0] + 1; i < t.end[0] + 1; ++i) {
+        stencil_row(n, i, t.begin[1] + 1, t.end[1] + 1, in, out);
+      }
+    });
+    std::swap(in, out);
+  }
+  endTime = high_resolution_clock::now();
+  printf("tiles: %zu x %zu\n", shape[0], shape[1]);
+  print_results("tiled (Morton) ", in == expected, startTime, endTime);
+}
+
+// ===================================================================
+// 7-point stencil (3D Jacobi), n x n x n, boundary fixed
+// ===================================================================
+inline void stencil_line(size_t n, size_t i, size_t j, size_t k0, size_t k1,
+                         std::vector<double> const &in,
+                         std::vector<double> &out) {
+  size_t const plane = n * n;
+  for (size_t k = k0; k < k1; ++k) {
+    size_t const x = i * plane + j * n + k;
+    out[x] = (in[x - plane] + in[x + plane] + in[x - n] + in[x + n] +
+              in[x - 1] + in[x + 1]) /
+             6.0;
+  }
+}
+
+void stencil_3d(thread_pool &pool, size_t n) {
+  printf("\n7-point stencil %zu x %zu x %zu, %zu sweeps...\n", n, n, n,
+         sweeps);
+  std::vector<double> const grid = make_matrix(n * n * n, n);
+
+  std::vector<double> in = grid;
+  std::vector<double> out = grid;
+  auto startTime = high_resolution_clock::now();
+  for (size_t s = 0; s < sweeps; ++s) {
+    parallel_for(
+        pool, 1, n - 1,
+        [&](size_t i) {
+          for (size_t j = 1; j < n - 1; ++j) {
+            stencil_line(n, i, j, 1, n - 1, in, out);
+          }
+        },
+        schedule::static_blocks);
+    std::swap(in, out);
+  }
+  auto endTime = high_resolution_clock::now();
+  print_results("plane partitioned", true, startTime, endTime);
+  std::vector<double> const expected = std::move(in);
+
+  in = grid;
+  out = grid;
+  std::array<size_t, 3> const interior{n - 2, n - 2, n - 2};
+  std::array<size_t, 3> const shape =
+      cache_tile_shape(interior, 2 * sizeof(double));
+  startTime = high_resolution_clock::now();
+  for (size_t s = 0; s < sweeps; ++s) {
+    parallel_for_tiled(pool, interior, shape, [&](tile_range<3> const &t) {
+      for (size_t i = t.begin[0] + 1; i < t.end[0] + 1; ++i) {
+        for (size_t j = t.begin[1] + 1; j < t.end[1] + 1; ++j) {
+          stencil_line(n, i, j, t.begin[2] + 1, t.end[2] + 1, in, out);
+        }
+      }
+    });
+    std::swap(in, out);
+  }
+  endTime = high_resolution_clock::now();
+  printf("tiles: %zu x %zu x %zu\n", shape[0], shape[1], shape[2]);
+  print_results("tiled (Morton)   ", in == expected, startTime, endTime);
+}
+
+int main(int argc, char **argv) {
+  const size_t maxSize = argc > 1 ? std::stoul(argv[1]) : 2048;
+  thread_pool pool;
+
+  cache_sizes const &cache = cache_sizes::get();
+  printf("L1d: %zuKB, L2: %zuKB\n", cache.l1 / 1024, cache.l2 / 1024);
+  for (size_t n = 256; n <= maxSize; n *= 2) {
+    matmul(pool, n);
+    stencil_2d(pool, 2 * n);
+    stencil_3d(pool, n / 8);
+  }
+  return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef BLOCK_PARTITION_H_
+#define BLOCK_PARTITION_H_
+
+#include <algorithm>
+#include <cstddef>
+
+// block_partition splits [0, length) into contiguous blocks, the same way
+// parallel_accumulate does (section_1/08_parallel_accumulate.cpp): as many
+// blocks as allowed by both the number of threads and a minimum block size.
+// Block sizes differ by at most one element.
+struct block_partition {
+  std::size_t length;
+  std::size_t num_blocks;
+
+  block_partition(std::size_t _length, std::size_t max_blocks,
+                  std::size_t min_block_size)
+      : length(_length),
+        num_blocks(std::max<std::size_t>(
+            1, std::min(max_blocks, _length / std::max<std::size_t>(
+                                                  1, min_block_size)))) {}
+
+  std::size_t begin(std::size_t block) const {
+    return block * length / num_blocks;
+  }
+  std::size_t end(std::size_t block) const { return begin(block + 1); }
+  std::size_t size(std::size_t block) const {
+    return end(block) - begin(block);
+  }
+};
+
+#endif /* BLOCK_PARTITION_H_ */
@@ -0,0 +1,54 @@
+#ifndef EXECUTION_POLICY_H_
+#define EXECUTION_POLICY_H_
+
+#include <cstddef>
+#include <stop_token>
+#include <utility>
+
+#include "section_8/thread_pool.h"
+
+// ===================================================================
+// Execution policy for the algorithms of this section
+// ===================================================================
+// std::execution::par runs on the standard library's own threads (TBB for
+// libstdc++), outside of our control. execution_policy routes the parallel
+// algorithms of this section onto one thread_pool instead, and carries:
+// - chunk_size: a hint for the number of elements handled at a time (block
+//   size, grain size, ...). 0 lets every algorithm pick its own.
+// - stop_token: cancellation. Once stop is requested, the algorithms stop
+//   starting new blocks and return early. Ranges are still permutations of
+//   the input, but the results are unspecified.
+// A thread_pool converts implicitly to a policy with the defaults, so
+// algorithms can also be called with a pool directly.
+struct execution_policy {
+  thread_pool &pool;
+  std::size_t chunk_size;
+  std::stop_token stop_token;
+
+  execution_policy(thread_pool &_pool, std::size_t _chunk_size = 0,
+                   std::stop_token _stop_token = {})
+      : pool(_pool), chunk_size(_chunk_size),
+        stop_token(std::move(_stop_token)) {}
+
+  // Number of threads running an algorithm: the workers and the caller.
+  std::size_t concurrency() const { return pool.size() + 1; }
+
+  bool stop_requested() const { return stop_token.stop_requested(); }
+
+  // The chunk size hint if there is one, the algorithm's default otherwise.
+  std::size_t chunk_size_or(std::size_t default_size) const {
+    return chunk_size != 0 ? chunk_size : default_size;
+  }
+
+  // thread_pool::fork_join, skipping the calls that start after a stop
+  // request.
+  template <typename F> void fork_join(std::size_t count, F const &f) const {
+    pool.fork_join(count, [this, &f](std::size_t i) {
+      if (!stop_requested()) {
+        f(i);
+      }
+    });
+  }
+};
+
+#endif /* EXECUTION_POLICY_H_ */
@@ -0,0 +1,223 @@
+#ifndef PARALLEL_FIND_H_
+#define PARALLEL_FIND_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "execution_policy.h"
+
+// ===================================================================
+// Parallel find: leftmost match, SIMD block scan
+// ===================================================================
+// parallel_find_promise (04_find.cpp) loads the done flag and compares a
+// single element per iteration, and returns any match. This version:
+// - Splits the range in chunks, handed out in increasing order through an
+//   atomic counter, so the threads sweep the range from left to right.
+// - Scans every chunk in cache line sized blocks (64 bytes). For arithmetic
+//   types on contiguous memory, the block is compared with SSE2 and
+//   reduced to a bitmask, one bit per element.
+// - Keeps the best (leftmost) match found so far in an atomic. It is read
+//   once per block: blocks to the right of a match are never scanned, and
+//   blocks to the left still are, so the result is the leftmost match.
+// The chunk size hint of the policy replaces the default chunk size. On
+// cancellation, the search stops after the current chunks and may miss
+// the match.
+namespace parallel_find_detail {
+
+constexpr std::size_t block_bytes = 64;
+constexpr std::size_t blocks_per_chunk = 256; // 16KB chunks
+
+template <typename T>
+constexpr std::size_t block_size =
+    std::max<std::size_t>(1, block_bytes / sizeof(T));
+
+// Bit i is set when block[i] == value, for a full block.
+template <typename T>
+std::uint64_t match_mask(T const *block, T const &value) {
+#if defined(__SSE2__)
+  if constexpr (std::is_integral_v<T> && sizeof(T) == 1) {
+    __m128i const v = _mm_set1_epi8(static_cast<char>(value));
+    std::uint64_t mask = 0;
+    for (int i = 0; i < 4; ++i) {
+      __m128i const x = _mm_loadu_si128(
+          reinterpret_cast<__m128i const *>(block) + i);
+      mask |= std::uint64_t(static_cast<std::uint16_t>(
+                  _mm_movemask_epi8(_mm_cmpeq_epi8(x, v))))
+              << (16 * i);
+    }
+    return mask;
+  } else if constexpr (std::is_integral_v<T> && sizeof(T) == 2) {
+    __m128i const v = _mm_set1_epi16(static_cast<short>(value));
+    std::uint64_t mask = 0;
+    for (int i = 0; i < 2; ++i) {
+      __m128i const *p = reinterpret_cast<__m128i const *>(block) + 2 * i;
+      __m128i const a = _mm_cmpeq_epi16(_mm_loadu_si128(p), v);
+      __m128i const b = _mm_cmpeq_epi16(_mm_loadu_si128(p + 1), v);
+      // pack the 16 bit lanes to bytes, one byte (bit) per element.
+      mask |= std::uint64_t(static_cast<std::uint16_t>(
+                  _mm_movemask_epi8(_mm_packs_epi16(a, b))))
+              << (16 * i);
+    }
+    return mask;
+  } else if constexpr (std::is_integral_v<T> && sizeof(T) == 4) {
+    __m128i const v = _mm_set1_epi32(static_cast<int>(value));
+    std::uint64_t mask = 0;
+    for (int i = 0; i < 4; ++i) {
+      __m128i const x = _mm_loadu_si128(
+          reinterpret_cast<__m128i const *>(block) + i);
+      mask |= std::uint64_t(_mm_movemask_ps(
+                  _mm_castsi128_ps(_mm_cmpeq_epi32(x, v))))
+              << (4 * i);
+    }
+    return mask;
+  } else if constexpr (std::is_integral_v<T> && sizeof(T) == 8) {
+    __m128i const v = _mm_set1_epi64x(static_cast<long long>(value));
+    std::uint64_t mask = 0;
+    for (int i = 0; i < 4; ++i) {
+      __m128i const x = _mm_loadu_si128(
+          reinterpret_cast<__m128i const *>(block) + i);
+      // SSE2 has no 64 bit compare: both 32 bit halves must match.
+      __m128i const eq32 = _mm_cmpeq_epi32(x, v);
+      __m128i const swapped =
+          _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1));
+      __m128i const eq64 = _mm_and_si128(eq32, swapped);
+      mask |= std::uint64_t(_mm_movemask_pd(_mm_castsi128_pd(eq64)))
+              << (2 * i);
+    }
+    return mask;
+  } else if constexpr (std::is_same_v<T, float>) {
+    __m128 const v = _mm_set1_ps(value);
+    std::uint64_t mask = 0;
+    for (int i = 0; i < 4; ++i) {
+      __m128 const x = _mm_loadu_ps(block + 4 * i);
+      mask |= std::uint64_t(_mm_movemask_ps(_mm_cmpeq_ps(x, v))) << (4 * i);
+    }
+    return mask;
+  } else if constexpr (std::is_same_v<T, double>) {
+    __m128d const v = _mm_set1_pd(value);
+    std::uint64_t mask = 0;
+    for (int i = 0; i < 4; ++i) {
+      __m128d const x = _mm_loadu_pd(block + 2 * i);
+      mask |= std::uint64_t(_mm_movemask_pd(_mm_cmpeq_pd(x, v))) << (2 * i);
+    }
+    return mask;
+  }
+#endif
+  // portable version, branch free so the compiler can vectorize it.
+  std::uint64_t mask = 0;
+  for (std::size_t i = 0; i < block_size<T>; ++i) {
+    mask |= std::uint64_t(block[i] == value) << i;
+  }
+  return mask;
+}
+
+// Lowers best to index, unless a match further left is already known.
+inline void update_best(std::atomic<std::size_t> &best, std::size_t index) {
+  std::size_t current = best.load(std::memory_order_relaxed);
+  while (index < current &&
+         !best.compare_exchange_weak(current, index,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+// Scans [begin, end) of a contiguous arithmetic range.
+template <typename T>
+void scan_chunk(T const *data, std::size_t begin, std::size_t end,
+                T const &value, std::atomic<std::size_t> &best) {
+  constexpr std::size_t block = block_size<T>;
+  std::size_t i = begin;
+  for (; i + block <= end; i += block) {
+    // cancellation check, once per block.
+    if (i >= best.load(std::memory_order_relaxed)) {
+      return;
+    }
+    std::uint64_t const mask = match_mask(data + i, value);
+    if (mask != 0) {
+      update_best(best, i + __builtin_ctzll(mask));
+      return;
+    }
+  }
+  for (; i < end; ++i) {
+    if (data[i] == value) {
+      update_best(best, i);
+      return;
+    }
+  }
+}
+
+// Scans [begin, end) of any random access range, element by element.
+template <typename RandomIt, typename MatchType>
+void scan_chunk(RandomIt first, std::size_t begin, std::size_t end,
+                MatchType const &match, std::atomic<std::size_t> &best) {
+  constexpr std::size_t block = 16;
+  for (std::size_t i = begin; i < end; i += block) {
+    if (i >= best.load(std::memory_order_relaxed)) {
+      return;
+    }
+    std::size_t const block_end = std::min(end, i + block);
+    for (std::size_t j = i; j < block_end; ++j) {
+      if (first[j] == match) {
+        update_best(best, j);
+        return;
+      }
+    }
+  }
+}
+
+} // namespace parallel_find_detail
+
+// Returns an iterator to the first element equal to match, or last.
+template <typename RandomIt, typename MatchType>
+RandomIt parallel_find(execution_policy const &policy, RandomIt first,
+                       RandomIt last, MatchType const &match) {
+  using namespace parallel_find_detail;
+  using T = std::iter_value_t<RandomIt>;
+  // SIMD compares need the match to have the element type.
+  constexpr bool simd = std::contiguous_iterator<RandomIt> &&
+                        std::is_arithmetic_v<T> &&
+                        !std::is_same_v<T, bool> &&
+                        std::is_same_v<MatchType, T>;
+
+  std::size_t const length = std::distance(first, last);
+  std::size_t const chunk_size =
+      policy.chunk_size_or(blocks_per_chunk * block_size<T>);
+  std::size_t const num_chunks = (length + chunk_size - 1) / chunk_size;
+
+  std::atomic<std::size_t> best{length};
+  std::atomic<std::size_t> next_chunk{0};
+
+  auto worker = [&](std::size_t) {
+    while (true) {
+      std::size_t const chunk =
+          next_chunk.fetch_add(1, std::memory_order_relaxed);
+      std::size_t const begin = chunk * chunk_size;
+      if (chunk >= num_chunks ||
+          begin >= best.load(std::memory_order_relaxed) ||
+          policy.stop_requested()) {
+        return;
+      }
+      std::size_t const end = std::min(length, begin + chunk_size);
+      if constexpr (simd) {
+        scan_chunk(std::to_address(first), begin, end, match, best);
+      } else {
+        scan_chunk(first, begin, end, match, best);
+      }
+    }
+  };
+
+  std::size_t const num_threads =
+      std::min<std::size_t>(policy.concurrency(), num_chunks);
+  policy.pool.fork_join(num_threads, worker);
+  return first + best.load();
+}
+
+#endif /* PARALLEL_FIND_H_ */
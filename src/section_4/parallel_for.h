@@ -0,0 +1,148 @@
+#ifndef PARALLEL_FOR_H_
+#define PARALLEL_FOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+
+#include "block_partition.h"
+#include "execution_policy.h"
+#include "section_8/task_scope.h"
+
+// ===================================================================
+// parallel_for with selectable schedules
+// ===================================================================
+// Calls body(i) for every i in [first, last), on the thread pool.
+// The schedule decides how the indices are handed to the threads:
+// - static_blocks: one contiguous block per thread, decided upfront. No
+//   overhead, but a thread with expensive elements finishes last.
+// - dynamic: threads grab chunk_size indices at a time from a shared
+//   atomic counter. Balances uneven work, at one atomic per chunk.
+// - guided: like dynamic, but every chunk is a fraction of the remaining
+//   work (never smaller than chunk_size). Few large chunks at the start,
+//   small ones at the end to balance the tail.
+// - lazy_splitting: lazy binary splitting. Each task runs its range
+//   chunk_size indices at a time, and only splits the remaining range in
+//   half (giving one half to the pool) when there are idle workers. Tasks
+//   are only created when some thread is actually asking for work.
+// chunk_size 0 uses the chunk size hint of the policy, or lets the schedule
+// pick one. On cancellation, no new chunk is started.
+enum class schedule { static_blocks, dynamic, guided, lazy_splitting };
+
+namespace parallel_for_detail {
+
+template <typename Body>
+void run_range(std::size_t begin, std::size_t end, Body const &body) {
+  for (std::size_t i = begin; i < end; ++i) {
+    body(i);
+  }
+}
+
+template <typename Body>
+void lazy_split(task_scope &scope, thread_pool &pool, std::size_t begin,
+                std::size_t end, std::size_t chunk_size, Body const &body) {
+  while (begin < end && !scope.stop_requested()) {
+    // steal demand: hand half of the remaining work to an idle worker.
+    if (end - begin > 2 * chunk_size && pool.idle_workers() > 0) {
+      std::size_t const mid = begin + (end - begin) / 2;
+      scope.spawn([&scope, &pool, mid, end, chunk_size, &body]() {
+        lazy_split(scope, pool, mid, end, chunk_size, body);
+      });
+      end = mid;
+    }
+    std::size_t const chunk_end = std::min(end, begin + chunk_size);
+    run_range(begin, chunk_end, body);
+    begin = chunk_end;
+  }
+}
+
+} // namespace parallel_for_detail
+
+template <typename Body>
+void parallel_for(execution_policy const &policy, std::size_t first,
+                  std::size_t last, Body const &body,
+                  schedule kind = schedule::lazy_splitting,
+                  std::size_t chunk_size = 0) {
+  using namespace parallel_for_detail;
+  if (first >= last) {
+    return;
+  }
+  std::size_t const length = last - first;
+  std::size_t const num_threads = policy.concurrency(); // workers + caller
+  if (chunk_size == 0) {
+    chunk_size = policy.chunk_size;
+  }
+  if (chunk_size == 0) {
+    // about 32 chunks per thread
+    chunk_size = std::max<std::size_t>(1, length / (32 * num_threads));
+  }
+
+  switch (kind) {
+  case schedule::static_blocks: {
+    block_partition const blocks(length, num_threads, chunk_size);
+    policy.fork_join(blocks.num_blocks, [&](std::size_t b) {
+      std::size_t const end = first + blocks.end(b);
+      // chunk by chunk, only to check for cancellation.
+      for (std::size_t begin = first + blocks.begin(b);
+           begin < end && !policy.stop_requested(); begin += chunk_size) {
+        run_range(begin, std::min(end, begin + chunk_size), body);
+      }
+    });
+    break;
+  }
+
+  case schedule::dynamic: {
+    std::atomic<std::size_t> next{first};
+    policy.pool.fork_join(num_threads, [&](std::size_t) {
+      while (true) {
+        std::size_t const begin =
+            next.fetch_add(chunk_size, std::memory_order_relaxed);
+        if (begin >= last || policy.stop_requested()) {
+          break;
+        }
+        run_range(begin, std::min(last, begin + chunk_size), body);
+      }
+    });
+    break;
+  }
+
+  case schedule::guided: {
+    std::atomic<std::size_t> next{first};
+    policy.pool.fork_join(num_threads, [&](std::size_t) {
+      std::size_t begin = next.load(std::memory_order_relaxed);
+      while (begin < last && !policy.stop_requested()) {
+        std::size_t const size =
+            std::max(chunk_size, (last - begin) / (2 * num_threads));
+        std::size_t const end = std::min(last, begin + size);
+        if (next.compare_exchange_weak(begin, end,
+                                       std::memory_order_relaxed)) {
+          run_range(begin, end, body);
+          begin = next.load(std::memory_order_relaxed);
+        }
+      }
+    });
+    break;
+  }
+
+  case schedule::lazy_splitting: {
+    task_scope scope(policy.pool, policy.stop_token);
+    lazy_split(scope, policy.pool, first, last, chunk_size, body);
+    scope.wait();
+    break;
+  }
+  }
+}
+
+// std::for_each style wrapper over random access iterators.
+template <typename RandomIt, typename Func>
+void parallel_for_each(execution_policy const &policy, RandomIt first,
+                       RandomIt last, Func f,
+                       schedule kind = schedule::lazy_splitting,
+                       std::size_t chunk_size = 0) {
+  parallel_for(
+      policy, 0, static_cast<std::size_t>(std::distance(first, last)),
+      [first, &f](std::size_t i) { f(first[i]); }, kind, chunk_size);
+}
+
+#endif /* PARALLEL_FOR_H_ */
@@ -0,0 +1,164 @@
+#ifndef PARALLEL_FOR_TILED_H_
+#define PARALLEL_FOR_TILED_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "execution_policy.h"
+#include "parallel_for.h"
+#include "section_6/spin_hints.h"
+
+// ===================================================================
+// Tiled parallel_for over 2D/3D index spaces
+// ===================================================================
+// Splits [0, extent[0]) x ... x [0, extent[N-1]) into tiles of a given
+// shape, and calls body(tile) once per tile on the thread pool. The last
+// dimension is the contiguous one (row-major arrays).
+//
+// The tiles are visited in Morton (Z) order: the bits of the tile
+// coordinates are interleaved, and the tiles are sorted by the result.
+// Tiles that are close in that order are close in every dimension, so a
+// contiguous run of tiles (what parallel_for gives one thread at a time)
+// covers a compact region, and shares its borders with the tiles that
+// were visited just before. The tiles are scheduled by parallel_for over
+// the Morton order, with any of its schedules.
+//
+// cache_tile_shape derives a tile shape from the cache sizes:
+// - the last dimension is sized so that a few tile rows of every array
+//   fit in L1 (a stencil reuses the rows above and below),
+// - the other dimensions share what is left of half of L2, so a whole
+//   tile stays in L2 while it is processed.
+template <std::size_t N> struct tile_range {
+  std::array<std::size_t, N> begin;
+  std::array<std::size_t, N> end;
+};
+
+// Data cache sizes, from sysconf, with common defaults when unknown.
+struct cache_sizes {
+  std::size_t l1;
+  std::size_t l2;
+
+  static cache_sizes const &get() {
+    static cache_sizes const sizes = [] {
+      long const l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+      long const l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+      return cache_sizes{l1 > 0 ? static_cast<std::size_t>(l1) : 32 * 1024,
+                         l2 > 0 ? static_cast<std::size_t>(l2)
+                                : 1024 * 1024};
+    }();
+    return sizes;
+  }
+};
+
+namespace parallel_for_tiled_detail {
+
+using spin_hints::cache_line_size;
+constexpr std::size_t l1_rows = 4; // tile rows kept in L1
+
+// Interleaves the bits of the coordinates: bit b of coordinate d goes to
+// bit b * N + (N - 1 - d) of the code.
+template <std::size_t N>
+std::uint64_t morton_code(std::array<std::size_t, N> const &coord) {
+  std::uint64_t code = 0;
+  for (std::size_t bit = 0; bit < 64 / N; ++bit) {
+    for (std::size_t d = 0; d < N; ++d) {
+      code |= static_cast<std::uint64_t>((coord[d] >> bit) & 1)
+              << (bit * N + (N - 1 - d));
+    }
+  }
+  return code;
+}
+
+} // namespace parallel_for_tiled_detail
+
+// Tile shape for an index space of the given extent, where every index
+// touches bytes_per_element bytes (summed over all arrays).
+template <std::size_t N>
+std::array<std::size_t, N>
+cache_tile_shape(std::array<std::size_t, N> const &extent,
+                 std::size_t bytes_per_element) {
+  using namespace parallel_for_tiled_detail;
+  static_assert(N > 0);
+  cache_sizes const &cache = cache_sizes::get();
+  std::size_t const bytes = std::max<std::size_t>(1, bytes_per_element);
+  std::size_t const line = std::max<std::size_t>(1, cache_line_size / bytes);
+
+  std::array<std::size_t, N> shape;
+  // last dimension: l1_rows tile rows in L1, in whole cache lines.
+  std::size_t const width =
+      std::max(line, cache.l1 / (l1_rows * bytes) / line * line);
+  shape[N - 1] = std::clamp<std::size_t>(width, 1, extent[N - 1]);
+  if constexpr (N > 1) {
+    // other dimensions: the same size, the whole tile in half of L2.
+    std::size_t const budget =
+        std::max<std::size_t>(1, cache.l2 / 2 / (shape[N - 1] * bytes));
+    auto side = static_cast<std::size_t>(
+        std::pow(static_cast<double>(budget), 1.0 / (N - 1)));
+    side = std::max<std::size_t>(1, side);
+    for (std::size_t d = 0; d + 1 < N; ++d) {
+      shape[d] = std::clamp<std::size_t>(side, 1, extent[d]);
+    }
+  }
+  return shape;
+}
+
+// Calls body(tile_range<N> const &) for every tile of the given shape.
+// Zero entries of shape are replaced by the whole extent. chunk_size
+// counts tiles.
+template <std::size_t N, typename Body>
+void parallel_for_tiled(execution_policy const &policy,
+                        std::array<std::size_t, N> const &extent,
+                        std::array<std::size_t, N> shape, Body const &body,
+                        schedule kind = schedule::lazy_splitting,
+                        std::size_t chunk_size = 0) {
+  using namespace parallel_for_tiled_detail;
+  std::array<std::size_t, N> counts; // tiles in every dimension
+  std::size_t num_tiles = 1;
+  for (std::size_t d = 0; d < N; ++d) {
+    if (extent[d] == 0) {
+      return;
+    }
+    if (shape[d] == 0 || shape[d] > extent[d]) {
+      shape[d] = extent[d];
+    }
+    counts[d] = (extent[d] + shape[d] - 1) / shape[d];
+    num_tiles *= counts[d];
+  }
+
+  // tile coordinates, sorted in Morton order.
+  std::vector<std::pair<std::uint64_t, std::array<std::size_t, N>>> order;
+  order.reserve(num_tiles);
+  std::array<std::size_t, N> coord{};
+  for (std::size_t t = 0; t < num_tiles; ++t) {
+    order.emplace_back(morton_code(coord), coord);
+    // next coordinate, last dimension first.
+    for (std::size_t d = N; d-- > 0;) {
+      if (++coord[d] < counts[d]) {
+        break;
+      }
+      coord[d] = 0;
+    }
+  }
+  std::sort(order.begin(), order.end(),
+            [](auto const &a, auto const &b) { return a.first < b.first; });
+
+  parallel_for(
+      policy, 0, num_tiles,
+      [&](std::size_t t) {
+        tile_range<N> tile;
+        for (std::size_t d = 0; d < N; ++d) {
+          tile.begin[d] = order[t].second[d] * shape[d];
+          tile.end[d] = std::min(extent[d], tile.begin[d] + shape[d]);
+        }
+        body(tile);
+      },
+      kind, chunk_size);
+}
+
+#endif /* PARALLEL_FOR_TILED_H_ */
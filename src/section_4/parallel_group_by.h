@@ -0,0 +1,188 @@
+#ifndef PARALLEL_GROUP_BY_H_
+#define PARALLEL_GROUP_BY_H_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "block_partition.h"
+#include "execution_policy.h"
+
+// ===================================================================
+// Parallel hash group-by
+// ===================================================================
+// Aggregates a state per key, like parallel_map_reduce with one state per
+// group. No table is ever shared between threads:
+// 1. Every block (one per thread) aggregates its rows into thread-private
+//    open addressing tables. The top bits of the key hash select one of
+//    num_partitions tables (radix partitioning), the low bits select the
+//    slot in that table.
+// 2. Partition p of every block holds the same subset of the keys, so the
+//    partitions are merged in parallel, each one by a single thread: the
+//    tables of partition p of all blocks are merged into one.
+// 3. The merged partitions are copied out to the result, in parallel, at
+//    offsets given by a prefix sum of their sizes.
+// The groups come out in no particular order. Key and State must be
+// default constructible. On cancellation, the result is empty.
+namespace parallel_group_by_detail {
+
+constexpr std::size_t min_block_size = 64 * 1024;
+constexpr std::size_t partitions_per_thread = 4;
+
+// std::hash is the identity for integers: the bits are mixed so both the
+// top (partition) and low (slot) bits depend on the whole key. Never 0,
+// which marks the empty slots.
+inline std::uint64_t mix(std::uint64_t h) {
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return h != 0 ? h : 1;
+}
+
+// Open addressing hash table with linear probing, at most half full.
+// Slots keep the hash, 0 marking the empty ones: a probe touches a single
+// slot, and only compares keys when the hashes are equal.
+template <typename Key, typename State> class group_table {
+  struct slot {
+    std::uint64_t hash = 0;
+    Key key;
+    State state;
+  };
+
+  std::vector<slot> slots;
+  std::size_t count = 0;
+
+  void grow() {
+    std::vector<slot> old_slots(std::move(slots));
+    slots.assign(old_slots.empty() ? 16 : 2 * old_slots.size(), slot{});
+    std::size_t const mask = slots.size() - 1;
+    for (auto &old : old_slots) {
+      if (old.hash != 0) {
+        std::size_t s = old.hash & mask;
+        while (slots[s].hash != 0) {
+          s = (s + 1) & mask;
+        }
+        slots[s] = std::move(old);
+      }
+    }
+  }
+
+public:
+  std::size_t size() const { return count; }
+
+  // State of key, inserted as a copy of init if the key is new. hash must
+  // not be 0.
+  State &find_or_insert(std::uint64_t hash, Key const &key,
+                        State const &init) {
+    if (2 * (count + 1) > slots.size()) {
+      grow();
+    }
+    std::size_t const mask = slots.size() - 1;
+    std::size_t s = hash & mask;
+    while (slots[s].hash != 0) {
+      if (slots[s].hash == hash && slots[s].key == key) {
+        return slots[s].state;
+      }
+      s = (s + 1) & mask;
+    }
+    ++count;
+    slots[s] = slot{hash, key, init};
+    return slots[s].state;
+  }
+
+  // Calls f(hash, key, state) for every group.
+  template <typename F> void for_each(F &&f) {
+    for (auto &slot : slots) {
+      if (slot.hash != 0) {
+        f(slot.hash, slot.key, slot.state);
+      }
+    }
+  }
+};
+
+} // namespace parallel_group_by_detail
+
+// Returns a (key, state) pair per distinct key_of(row). Every group starts
+// from a copy of init, rows are folded in with accumulate(State &, row),
+// and the states of a group from different threads are combined with
+// merge(State &, State &&).
+template <typename RandomIt, typename KeyOf, typename State,
+          typename Accumulate, typename Merge,
+          typename Hash = std::hash<std::decay_t<
+              std::invoke_result_t<KeyOf &, std::iter_reference_t<RandomIt>>>>>
+std::vector<std::pair<
+    std::decay_t<
+        std::invoke_result_t<KeyOf &, std::iter_reference_t<RandomIt>>>,
+    State>>
+parallel_group_by(execution_policy const &policy, RandomIt first,
+                  RandomIt last, KeyOf key_of, State const &init,
+                  Accumulate accumulate, Merge merge, Hash hash = Hash()) {
+  using namespace parallel_group_by_detail;
+  using Key = std::decay_t<
+      std::invoke_result_t<KeyOf &, std::iter_reference_t<RandomIt>>>;
+  using table = group_table<Key, State>;
+
+  std::size_t const length = std::distance(first, last);
+  block_partition const blocks(length, policy.concurrency(),
+                               policy.chunk_size_or(min_block_size));
+  std::size_t const num_partitions =
+      std::bit_ceil(partitions_per_thread * policy.concurrency());
+  int const partition_shift = 64 - std::countr_zero(num_partitions);
+  auto partition_of = [&](std::uint64_t h) -> std::size_t {
+    return num_partitions == 1 ? 0 : h >> partition_shift;
+  };
+
+  // 1. thread-private tables
+  std::vector<std::vector<table>> tables(blocks.num_blocks);
+  policy.fork_join(blocks.num_blocks, [&](std::size_t b) {
+    std::vector<table> local(num_partitions);
+    for (std::size_t i = blocks.begin(b); i < blocks.end(b); ++i) {
+      Key const key = key_of(first[i]);
+      std::uint64_t const h = mix(hash(key));
+      accumulate(local[partition_of(h)].find_or_insert(h, key, init),
+                 first[i]);
+    }
+    tables[b] = std::move(local);
+  });
+  if (policy.stop_requested()) {
+    return {};
+  }
+
+  // 2. merge every partition, into the tables of block 0
+  policy.fork_join(num_partitions, [&](std::size_t p) {
+    table &target = tables[0][p];
+    for (std::size_t b = 1; b < blocks.num_blocks; ++b) {
+      tables[b][p].for_each(
+          [&](std::uint64_t h, Key const &key, State &state) {
+            merge(target.find_or_insert(h, key, init), std::move(state));
+          });
+      tables[b][p] = table(); // free it early
+    }
+  });
+  if (policy.stop_requested()) {
+    return {};
+  }
+
+  // 3. copy out
+  std::vector<std::size_t> offsets(num_partitions + 1, 0);
+  for (std::size_t p = 0; p < num_partitions; ++p) {
+    offsets[p + 1] = offsets[p] + tables[0][p].size();
+  }
+  std::vector<std::pair<Key, State>> groups(offsets[num_partitions]);
+  policy.fork_join(num_partitions, [&](std::size_t p) {
+    std::size_t out = offsets[p];
+    tables[0][p].for_each([&](std::uint64_t, Key &key, State &state) {
+      groups[out++] = {std::move(key), std::move(state)};
+    });
+  });
+  return groups;
+}
+
+#endif /* PARALLEL_GROUP_BY_H_ */
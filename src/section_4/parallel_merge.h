@@ -0,0 +1,280 @@
+#ifndef PARALLEL_MERGE_H_
+#define PARALLEL_MERGE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "block_partition.h"
+#include "execution_policy.h"
+
+// ===================================================================
+// Parallel merge of sorted ranges
+// ===================================================================
+// Both merges split the output into blocks, and merge every block on the
+// pool, independently of the others.
+//
+// parallel_merge (two ranges): the inputs of every output block are found
+// by co-ranking. The first k output elements are the first i elements of
+// a and the first k - i of b, and i is found by binary search on both
+// inputs at once. Each block then runs std::merge on its slices.
+//
+// parallel_multiway_merge (k ranges): the blocks are cut at splitter
+// values, picked from a regular sample of all runs. A block holds the
+// elements between two splitters, found by lower_bound in every run.
+// Every block is merged with a loser tree: a tournament tree holding the
+// loser of every match, so replacing the winner only replays the matches
+// on its path to the root (log k comparisons, no heap sift down).
+//
+// Both merges are stable: equal elements come from the earlier range
+// first.
+namespace parallel_merge_detail {
+
+constexpr std::size_t min_block_size = 64 * 1024;
+constexpr std::size_t samples_per_block = 16;
+
+// Number of elements of a among the first k elements of the merge of a
+// (size m) and b (size n).
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+std::size_t corank(std::size_t k, RandomIt1 a, std::size_t m, RandomIt2 b,
+                   std::size_t n, Compare &comp) {
+  std::size_t lo = k > n ? k - n : 0;
+  std::size_t hi = std::min(k, m);
+  // smallest i such that a[i] comes after b[k - i - 1].
+  while (lo < hi) {
+    std::size_t const i = lo + (hi - lo) / 2;
+    std::size_t const j = k - i;
+    if (j > 0 && !comp(b[j - 1], a[i])) {
+      lo = i + 1; // a[i] <= b[j - 1]: a[i] is among the first k
+    } else {
+      hi = i;
+    }
+  }
+  return lo;
+}
+
+// Sequential k-way merge of [run.first, run.second) ranges. The current
+// element of every run is copied into keys, next to each other, so the
+// matches do not go back to the runs.
+// Exhausted runs (and the padding leaves) get a sentinel: the largest
+// element of all runs as key, and a rank after every live run, so they
+// lose every match without a separate check.
+template <typename RandomIt, typename Compare> class loser_tree {
+  using T = std::iter_value_t<RandomIt>;
+
+  std::vector<std::pair<RandomIt, RandomIt>> runs;
+  std::vector<T> keys;            // current element of every run
+  std::vector<std::size_t> ranks; // tie breaks: run index, or sentinel
+  std::vector<std::size_t> tree;  // tree[0]: winner, others: losers
+  std::size_t leaves;             // runs.size() rounded up to a power of 2
+  Compare &comp;
+  T sentinel{};
+
+  // true if run a goes before run b. On ties the lower rank goes first.
+  // Both comparisons are evaluated, without branches.
+  bool wins(std::size_t a, std::size_t b) const {
+    bool const less = comp(keys[a], keys[b]);
+    bool const greater = comp(keys[b], keys[a]);
+    return less | ((ranks[a] < ranks[b]) & !greater);
+  }
+
+  void advance(std::size_t run) {
+    auto &[first, last] = runs[run];
+    if (first == last) {
+      keys[run] = sentinel;
+      ranks[run] = leaves + run;
+    } else {
+      keys[run] = *first++;
+    }
+  }
+
+  // Plays the matches of the subtree under node, returns the winner.
+  std::size_t build(std::size_t node) {
+    if (node >= leaves) {
+      return node - leaves;
+    }
+    std::size_t const left = build(2 * node);
+    std::size_t const right = build(2 * node + 1);
+    if (wins(left, right)) {
+      tree[node] = right;
+      return left;
+    }
+    tree[node] = left;
+    return right;
+  }
+
+public:
+  loser_tree(std::vector<std::pair<RandomIt, RandomIt>> _runs,
+             Compare &_comp)
+      : runs(std::move(_runs)), comp(_comp) {
+    leaves = 1;
+    while (leaves < runs.size()) {
+      leaves *= 2;
+    }
+    for (auto const &[first, last] : runs) {
+      if (first != last && comp(sentinel, *(last - 1))) {
+        sentinel = *(last - 1);
+      }
+    }
+    keys.resize(leaves, sentinel);
+    ranks.resize(leaves);
+    for (std::size_t run = 0; run < leaves; ++run) {
+      ranks[run] = run < runs.size() ? run : leaves + run;
+      if (run < runs.size()) {
+        advance(run);
+      }
+    }
+    tree.resize(leaves);
+    tree[0] = build(1);
+  }
+
+  // Writes the next count elements to out.
+  template <typename OutputIt> OutputIt merge(std::size_t count, OutputIt out) {
+    for (; count > 0; --count) {
+      std::size_t winner = tree[0];
+      *out++ = std::move(keys[winner]);
+      advance(winner);
+      // replay the matches from the winner's leaf to the root.
+      for (std::size_t node = (winner + leaves) / 2; node > 0; node /= 2) {
+        std::size_t const loser = tree[node];
+        // selects instead of branches: the outcome is unpredictable.
+        bool const swap = wins(loser, winner);
+        tree[node] = swap ? winner : loser;
+        winner = swap ? loser : winner;
+      }
+      tree[0] = winner;
+    }
+    return out;
+  }
+};
+
+} // namespace parallel_merge_detail
+
+template <typename RandomIt1, typename RandomIt2, typename OutputIt,
+          typename Compare = std::less<>>
+OutputIt parallel_merge(execution_policy const &policy, RandomIt1 first1,
+                        RandomIt1 last1, RandomIt2 first2, RandomIt2 last2,
+                        OutputIt d_first, Compare comp = Compare()) {
+  using namespace parallel_merge_detail;
+  std::size_t const m = std::distance(first1, last1);
+  std::size_t const n = std::distance(first2, last2);
+  block_partition const blocks(m + n, policy.concurrency(),
+                               policy.chunk_size_or(min_block_size));
+  policy.fork_join(blocks.num_blocks, [&](std::size_t b) {
+    std::size_t const k0 = blocks.begin(b);
+    std::size_t const k1 = blocks.end(b);
+    std::size_t const i0 = corank(k0, first1, m, first2, n, comp);
+    std::size_t const i1 = corank(k1, first1, m, first2, n, comp);
+    std::merge(first1 + i0, first1 + i1, first2 + (k0 - i0),
+               first2 + (k1 - i1), d_first + k0, comp);
+  });
+  return d_first + (m + n);
+}
+
+// Merges the sorted runs [runs[r].first, runs[r].second) into d_first.
+template <typename RandomIt, typename OutputIt,
+          typename Compare = std::less<>>
+OutputIt
+parallel_multiway_merge(execution_policy const &policy,
+                        std::vector<std::pair<RandomIt, RandomIt>> const &runs,
+                        OutputIt d_first, Compare comp = Compare()) {
+  using namespace parallel_merge_detail;
+  using T = std::iter_value_t<RandomIt>;
+  std::size_t total = 0;
+  for (auto const &run : runs) {
+    total += run.second - run.first;
+  }
+  std::size_t const num_blocks =
+      block_partition(total, policy.concurrency(),
+                      policy.chunk_size_or(min_block_size))
+          .num_blocks;
+
+  // splitters: regular sample of the runs (taken as one sequence, so
+  // longer runs get more samples), sorted, then every
+  // samples_per_block-th sample.
+  std::vector<T> splitters;
+  if (num_blocks > 1) {
+    std::size_t const num_samples = num_blocks * samples_per_block;
+    std::vector<T> sample;
+    std::size_t r = 0;
+    std::size_t run_offset = 0; // elements in the runs before run r
+    for (std::size_t t = 0; t < num_samples; ++t) {
+      std::size_t const position = (2 * t + 1) * total / (2 * num_samples);
+      while (position >= run_offset + (runs[r].second - runs[r].first)) {
+        run_offset += runs[r].second - runs[r].first;
+        ++r;
+      }
+      sample.push_back(runs[r].first[position - run_offset]);
+    }
+    std::sort(sample.begin(), sample.end(), comp);
+    for (std::size_t s = 1; s < num_blocks; ++s) {
+      splitters.push_back(sample[s * sample.size() / num_blocks]);
+    }
+  }
+
+  // bounds[s][r]: start of block s in run r. Ties go to the later block
+  // in every run, so every block holds whole groups of equal elements.
+  std::vector<std::vector<RandomIt>> bounds(num_blocks + 1);
+  std::vector<std::size_t> offsets(num_blocks + 1, 0); // output offsets
+  for (std::size_t s = 0; s <= num_blocks; ++s) {
+    for (auto const &run : runs) {
+      RandomIt const bound =
+          s == 0            ? run.first
+          : s == num_blocks ? run.second
+                            : std::lower_bound(run.first, run.second,
+                                               splitters[s - 1], comp);
+      bounds[s].push_back(bound);
+      offsets[s] += bound - run.first;
+    }
+  }
+
+  policy.fork_join(num_blocks, [&](std::size_t b) {
+    std::vector<std::pair<RandomIt, RandomIt>> slices;
+    for (std::size_t r = 0; r < runs.size(); ++r) {
+      slices.emplace_back(bounds[b][r], bounds[b + 1][r]);
+    }
+    loser_tree<RandomIt, Compare> tree(std::move(slices), comp);
+    tree.merge(offsets[b + 1] - offsets[b], d_first + offsets[b]);
+  });
+  return d_first + total;
+}
+
+// Stable sort: every block is sorted on the pool with std::stable_sort,
+// and the sorted blocks are merged with parallel_multiway_merge, through
+// a buffer of the same size.
+template <typename RandomIt, typename Compare = std::less<>>
+void parallel_stable_sort(execution_policy const &policy, RandomIt first,
+                          RandomIt last, Compare comp = Compare()) {
+  using namespace parallel_merge_detail;
+  std::size_t const length = std::distance(first, last);
+  block_partition const blocks(length, policy.concurrency(),
+                               policy.chunk_size_or(min_block_size));
+  if (blocks.num_blocks == 1) {
+    std::stable_sort(first, last, comp);
+    return;
+  }
+
+  policy.fork_join(blocks.num_blocks, [&](std::size_t b) {
+    std::stable_sort(first + blocks.begin(b), first + blocks.end(b), comp);
+  });
+  if (policy.stop_requested()) {
+    return;
+  }
+
+  using T = std::iter_value_t<RandomIt>;
+  std::vector<T> buffer(std::make_move_iterator(first),
+                        std::make_move_iterator(last));
+  std::vector<std::pair<typename std::vector<T>::iterator,
+                        typename std::vector<T>::iterator>>
+      runs;
+  for (std::size_t b = 0; b < blocks.num_blocks; ++b) {
+    runs.emplace_back(buffer.begin() + blocks.begin(b),
+                      buffer.begin() + blocks.end(b));
+  }
+  parallel_multiway_merge(policy, runs, first, comp);
+}
+
+#endif /* PARALLEL_MERGE_H_ */
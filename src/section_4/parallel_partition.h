@@ -0,0 +1,171 @@
+#ifndef PARALLEL_PARTITION_H_
+#define PARALLEL_PARTITION_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "block_partition.h"
+#include "execution_policy.h"
+
+// ===================================================================
+// Parallel partition
+// ===================================================================
+// Same result as std::partition (not stable), in three steps:
+// 1. Every block is partitioned on the pool with std::partition. Block b
+//    now holds its count[b] matching elements first.
+// 2. The total count gives the final partition point. The misplaced
+//    elements are the non matching ones left of it, and the matching ones
+//    right of it: there are as many of each, and in every block they form
+//    a single interval. Both lists of intervals are built sequentially
+//    (one or two intervals per block).
+// 3. The k-th misplaced element on the left is swapped with the k-th one
+//    on the right. The swaps are split evenly between the threads, and run
+//    as std::swap_ranges over whole intervals.
+// pred is called concurrently and must not modify shared state. On
+// cancellation, the blocks are left partitioned on their own, and last is
+// returned.
+namespace parallel_partition_detail {
+
+constexpr std::size_t min_block_size = 16 * 1024;
+
+// [begin, end) indices into the range.
+struct interval {
+  std::size_t begin;
+  std::size_t end;
+};
+
+// Misplaced elements on one side of the partition point, in index order.
+struct misplaced {
+  std::vector<interval> intervals;
+  std::vector<std::size_t> offsets; // misplaced elements before intervals[i]
+  std::size_t count = 0;
+
+  void add(std::size_t begin, std::size_t end) {
+    if (begin < end) {
+      intervals.push_back({begin, end});
+      offsets.push_back(count);
+      count += end - begin;
+    }
+  }
+
+  // Interval holding the k-th misplaced element, and the element's index.
+  std::pair<std::size_t, std::size_t> locate(std::size_t k) const {
+    std::size_t const i =
+        std::upper_bound(offsets.begin(), offsets.end(), k) -
+        offsets.begin() - 1;
+    return {i, intervals[i].begin + (k - offsets[i])};
+  }
+};
+
+// Swaps the misplaced elements [k, k_end) of left and right.
+template <typename RandomIt>
+void swap_misplaced(RandomIt first, misplaced const &left,
+                    misplaced const &right, std::size_t k,
+                    std::size_t k_end) {
+  if (k == k_end) {
+    return;
+  }
+  auto [i, x] = left.locate(k);
+  auto [j, y] = right.locate(k);
+  while (true) {
+    std::size_t const n = std::min(
+        {k_end - k, left.intervals[i].end - x, right.intervals[j].end - y});
+    std::swap_ranges(first + x, first + x + n, first + y);
+    k += n;
+    if (k == k_end) {
+      return;
+    }
+    x += n;
+    y += n;
+    if (x == left.intervals[i].end) {
+      x = left.intervals[++i].begin;
+    }
+    if (y == right.intervals[j].end) {
+      y = right.intervals[++j].begin;
+    }
+  }
+}
+
+// Copy of the median of 9 elements spread over [first, last), a pivot
+// for the partition based algorithms.
+template <typename RandomIt, typename Compare>
+std::iter_value_t<RandomIt> sample_pivot(RandomIt first, RandomIt last,
+                                         Compare &comp) {
+  std::ptrdiff_t const step = (last - first) / 9;
+  std::array<std::iter_value_t<RandomIt>, 9> samples{
+      first[0],        first[step],     first[2 * step],
+      first[3 * step], first[4 * step], first[5 * step],
+      first[6 * step], first[7 * step], first[8 * step]};
+  std::nth_element(samples.begin(), samples.begin() + 4, samples.end(), comp);
+  return samples[4];
+}
+
+} // namespace parallel_partition_detail
+
+// Reorders [first, last) so the elements matching pred come first, and
+// returns the first non matching element.
+template <typename RandomIt, typename Predicate>
+RandomIt parallel_partition(execution_policy const &policy, RandomIt first,
+                            RandomIt last, Predicate pred) {
+  using namespace parallel_partition_detail;
+  std::size_t const length = std::distance(first, last);
+  std::size_t const block_size = policy.chunk_size_or(min_block_size);
+  block_partition const blocks(length, policy.concurrency(), block_size);
+  if (blocks.num_blocks == 1) {
+    return std::partition(first, last, pred);
+  }
+
+  // 1. partition every block
+  std::vector<std::size_t> counts(blocks.num_blocks);
+  policy.fork_join(blocks.num_blocks, [&](std::size_t b) {
+    RandomIt const begin = first + blocks.begin(b);
+    counts[b] = std::partition(begin, first + blocks.end(b), pred) - begin;
+  });
+  if (policy.stop_requested()) {
+    return last;
+  }
+
+  // 2. misplaced elements on both sides of the partition point
+  std::size_t cut = 0;
+  for (std::size_t count : counts) {
+    cut += count;
+  }
+  misplaced left, right;
+  for (std::size_t b = 0; b < blocks.num_blocks; ++b) {
+    std::size_t const begin = blocks.begin(b);
+    std::size_t const middle = begin + counts[b];
+    std::size_t const end = blocks.end(b);
+    left.add(middle, std::min(end, cut));    // non matching, left of cut
+    right.add(std::max(begin, cut), middle); // matching, right of cut
+  }
+
+  // 3. swap them
+  std::size_t const swaps = left.count; // == right.count
+  block_partition const chunks(swaps, policy.concurrency(), block_size);
+  // not cancelled: a partial swap would still be a permutation, but this
+  // step is short compared to the first one.
+  policy.pool.fork_join(chunks.num_blocks, [&](std::size_t c) {
+    swap_misplaced(first, left, right, chunks.begin(c), chunks.end(c));
+  });
+  return first + cut;
+}
+
+// Three way partition around pivot: returns {lower, upper} such that
+// [first, lower) < pivot, [lower, upper) == pivot and [upper, last) > pivot.
+// Takes a copy of the pivot, since the elements move.
+template <typename RandomIt, typename T, typename Compare>
+std::pair<RandomIt, RandomIt>
+parallel_partition3(execution_policy const &policy, RandomIt first,
+                    RandomIt last, T const pivot, Compare &comp) {
+  RandomIt const lower = parallel_partition(
+      policy, first, last, [&](auto const &x) { return comp(x, pivot); });
+  RandomIt const upper = parallel_partition(
+      policy, lower, last, [&](auto const &x) { return !comp(pivot, x); });
+  return {lower, upper};
+}
+
+#endif /* PARALLEL_PARTITION_H_ */
@@ -0,0 +1,150 @@
+#ifndef PARALLEL_REDUCE_H_
+#define PARALLEL_REDUCE_H_
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "block_partition.h"
+#include "execution_policy.h"
+
+// ===================================================================
+// Parallel map-reduce: transform_reduce and per-thread state objects
+// ===================================================================
+// Same shape as parallel_accumulate (section_1/08_parallel_accumulate.cpp):
+// the range is split into blocks, every block is reduced on the pool into
+// a partial result, and the partial results are combined by the caller, in
+// block order (so the reducer only has to be associative, not commutative).
+//
+// Two entry points:
+// - parallel_transform_reduce: std::transform_reduce on the thread pool.
+//   transform(element) -> T, reduce(T, T) -> T.
+// - parallel_map_reduce: for state objects (histograms, min/max/mean, ...)
+//   that are updated in place. Every block starts from a copy of init,
+//   which must be an empty state, folds its elements in with
+//   accumulate(State &, element), and the block states are combined with
+//   merge(State &, State &&). One state per block: nothing is allocated
+//   per element.
+// On cancellation, the blocks that did not run are left out of the result.
+namespace parallel_reduce_detail {
+
+constexpr std::size_t min_block_size = 16 * 1024;
+
+// Reduces every block of [0, length) with reduce_block(begin, end) on the
+// pool, and returns the partial results in block order. Blocks fold into
+// a local value and only write their result once, at the end.
+template <typename T, typename ReduceBlock>
+std::vector<T> reduce_blocks(execution_policy const &policy,
+                             std::size_t length,
+                             ReduceBlock const &reduce_block) {
+  block_partition const blocks(length, policy.concurrency(),
+                               policy.chunk_size_or(min_block_size));
+  // T may have no default constructor: the slots are filled in place.
+  std::vector<std::optional<T>> results(blocks.num_blocks);
+  policy.fork_join(blocks.num_blocks, [&](std::size_t b) {
+    results[b].emplace(reduce_block(blocks.begin(b), blocks.end(b)));
+  });
+
+  std::vector<T> partials;
+  partials.reserve(blocks.num_blocks);
+  for (auto &result : results) {
+    if (result) { // empty if cancelled
+      partials.push_back(std::move(*result));
+    }
+  }
+  return partials;
+}
+
+} // namespace parallel_reduce_detail
+
+template <typename RandomIt, typename State, typename Accumulate,
+          typename Merge>
+State parallel_map_reduce(execution_policy const &policy, RandomIt first,
+                          RandomIt last, State init, Accumulate accumulate,
+                          Merge merge) {
+  using namespace parallel_reduce_detail;
+  std::size_t const length = std::distance(first, last);
+  if (length == 0) {
+    return init;
+  }
+
+  auto partials = reduce_blocks<State>(
+      policy, length, [&](std::size_t begin, std::size_t end) {
+        State state(init); // local: not shared with other blocks
+        for (std::size_t i = begin; i < end; ++i) {
+          accumulate(state, first[i]);
+        }
+        return state;
+      });
+  if (partials.empty()) {
+    return init;
+  }
+
+  State result = std::move(partials[0]);
+  for (std::size_t b = 1; b < partials.size(); ++b) {
+    merge(result, std::move(partials[b]));
+  }
+  return result;
+}
+
+template <typename RandomIt, typename T, typename BinaryOp,
+          typename UnaryOp>
+  requires std::invocable<UnaryOp &, std::iter_reference_t<RandomIt>>
+T parallel_transform_reduce(execution_policy const &policy, RandomIt first,
+                            RandomIt last, T init, BinaryOp reduce,
+                            UnaryOp transform) {
+  using namespace parallel_reduce_detail;
+  std::size_t const length = std::distance(first, last);
+  if (length == 0) {
+    return init;
+  }
+
+  // init is used once, not per block: blocks start from their first
+  // element.
+  auto partials = reduce_blocks<T>(
+      policy, length, [&](std::size_t begin, std::size_t end) {
+        T acc = transform(first[begin]);
+        for (std::size_t i = begin + 1; i < end; ++i) {
+          acc = reduce(std::move(acc), transform(first[i]));
+        }
+        return acc;
+      });
+
+  T result = std::move(init);
+  for (auto &partial : partials) {
+    result = reduce(std::move(result), std::move(partial));
+  }
+  return result;
+}
+
+// Inner product style overload: transform(a, b) over two ranges.
+template <typename RandomIt1, typename RandomIt2, typename T,
+          typename BinaryOp = std::plus<>,
+          typename BinaryTransform = std::multiplies<>>
+  requires std::random_access_iterator<RandomIt2>
+T parallel_transform_reduce(execution_policy const &policy, RandomIt1 first1,
+                            RandomIt1 last1, RandomIt2 first2, T init,
+                            BinaryOp reduce = BinaryOp(),
+                            BinaryTransform transform = BinaryTransform()) {
+  std::size_t const length = std::distance(first1, last1);
+  auto const indices = std::views::iota(std::size_t(0), length);
+  return parallel_transform_reduce(
+      policy, indices.begin(), indices.end(), std::move(init), reduce,
+      [&](std::size_t i) { return transform(first1[i], first2[i]); });
+}
+
+// parallel_accumulate (section_1/08_parallel_accumulate.cpp) on the pool.
+template <typename RandomIt, typename T, typename BinaryOp = std::plus<>>
+T parallel_accumulate(execution_policy const &policy, RandomIt first,
+                      RandomIt last, T init, BinaryOp op = BinaryOp()) {
+  return parallel_transform_reduce(policy, first, last, std::move(init), op,
+                                   [](auto const &x) { return T(x); });
+}
+
+#endif /* PARALLEL_REDUCE_H_ */
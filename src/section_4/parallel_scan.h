@@ -0,0 +1,157 @@
+#ifndef PARALLEL_SCAN_H_
+#define PARALLEL_SCAN_H_
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "block_partition.h"
+#include "execution_policy.h"
+
+// ===================================================================
+// Parallel inclusive / exclusive scan (prefix sum)
+// ===================================================================
+// Two passes over blocks, as in parallel_accumulate:
+// 1. Every block is reduced on the pool (except the last one, whose total
+//    is not needed).
+// 2. The block totals are scanned sequentially (one value per block),
+//    giving the starting value of every block.
+// 3. Every block is scanned on the pool, starting from its value.
+// The input is read twice, and op must be associative. Each element is
+// read before its output is written, so d_first == first (in place) works.
+// On cancellation, the output is partially written.
+namespace parallel_scan_detail {
+
+constexpr std::size_t min_block_size = 16 * 1024;
+
+template <bool Exclusive, typename RandomIt, typename OutputIt,
+          typename BinaryOp, typename UnaryOp, typename T>
+OutputIt scan(execution_policy const &policy, RandomIt first,
+              RandomIt last, OutputIt d_first, BinaryOp op,
+              UnaryOp transform, std::optional<T> init) {
+  std::size_t const length = std::distance(first, last);
+  if (length == 0) {
+    return d_first;
+  }
+
+  // Scans [i, end) starting from start (if any).
+  auto scan_block = [&](std::size_t i, std::size_t end,
+                        std::optional<T> start) {
+    if (!start) {
+      // only inclusive scans may start without a value.
+      start = transform(first[i]);
+      d_first[i++] = *start;
+    }
+    T acc = std::move(*start);
+    for (; i < end; ++i) {
+      T value = transform(first[i]); // read before writing (in place)
+      if constexpr (Exclusive) {
+        T next = op(acc, std::move(value));
+        d_first[i] = std::move(acc);
+        acc = std::move(next);
+      } else {
+        acc = op(std::move(acc), std::move(value));
+        d_first[i] = acc;
+      }
+    }
+  };
+
+  block_partition const blocks(length, policy.concurrency(),
+                               policy.chunk_size_or(min_block_size));
+  if (blocks.num_blocks == 1) {
+    scan_block(0, length, std::move(init));
+    return d_first + length;
+  }
+
+  // 1. reduce every block but the last one
+  std::vector<std::optional<T>> totals(blocks.num_blocks - 1);
+  policy.fork_join(blocks.num_blocks - 1, [&](std::size_t b) {
+    std::size_t i = blocks.begin(b);
+    T acc = transform(first[i]);
+    for (++i; i < blocks.end(b); ++i) {
+      acc = op(std::move(acc), transform(first[i]));
+    }
+    totals[b] = std::move(acc);
+  });
+  if (policy.stop_requested()) {
+    return d_first + length;
+  }
+
+  // 2. starting value of every block
+  std::vector<std::optional<T>> offsets(blocks.num_blocks);
+  offsets[0] = std::move(init);
+  for (std::size_t b = 1; b < blocks.num_blocks; ++b) {
+    T &total = *totals[b - 1];
+    offsets[b] = offsets[b - 1] ? op(*offsets[b - 1], std::move(total))
+                                : std::move(total);
+  }
+
+  // 3. scan every block
+  policy.fork_join(blocks.num_blocks, [&](std::size_t b) {
+    scan_block(blocks.begin(b), blocks.end(b), std::move(offsets[b]));
+  });
+  return d_first + length;
+}
+
+struct identity {
+  template <typename T> T &&operator()(T &&value) const {
+    return std::forward<T>(value);
+  }
+};
+
+} // namespace parallel_scan_detail
+
+template <typename RandomIt, typename OutputIt,
+          typename BinaryOp = std::plus<>>
+OutputIt parallel_inclusive_scan(execution_policy const &policy,
+                                 RandomIt first, RandomIt last,
+                                 OutputIt d_first, BinaryOp op = BinaryOp()) {
+  using T = std::iter_value_t<RandomIt>;
+  return parallel_scan_detail::scan<false>(policy, first, last, d_first, op,
+                                           parallel_scan_detail::identity(),
+                                           std::optional<T>());
+}
+
+template <typename RandomIt, typename OutputIt, typename T,
+          typename BinaryOp = std::plus<>>
+OutputIt parallel_exclusive_scan(execution_policy const &policy,
+                                 RandomIt first, RandomIt last,
+                                 OutputIt d_first, T init,
+                                 BinaryOp op = BinaryOp()) {
+  return parallel_scan_detail::scan<true>(policy, first, last, d_first, op,
+                                          parallel_scan_detail::identity(),
+                                          std::optional<T>(std::move(init)));
+}
+
+template <typename RandomIt, typename OutputIt, typename BinaryOp,
+          typename UnaryOp>
+OutputIt parallel_transform_inclusive_scan(execution_policy const &policy,
+                                           RandomIt first, RandomIt last,
+                                           OutputIt d_first, BinaryOp op,
+                                           UnaryOp transform) {
+  using T = std::decay_t<
+      std::invoke_result_t<UnaryOp &, std::iter_reference_t<RandomIt>>>;
+  return parallel_scan_detail::scan<false>(policy, first, last, d_first, op,
+                                           transform, std::optional<T>());
+}
+
+// In place variants: the output overwrites the input.
+template <typename RandomIt, typename BinaryOp = std::plus<>>
+void parallel_inclusive_scan_inplace(execution_policy const &policy,
+                                     RandomIt first, RandomIt last,
+                                     BinaryOp op = BinaryOp()) {
+  parallel_inclusive_scan(policy, first, last, first, op);
+}
+
+template <typename RandomIt, typename T, typename BinaryOp = std::plus<>>
+void parallel_exclusive_scan_inplace(execution_policy const &policy,
+                                     RandomIt first, RandomIt last, T init,
+                                     BinaryOp op = BinaryOp()) {
+  parallel_exclusive_scan(policy, first, last, first, std::move(init), op);
+}
+
+#endif /* PARALLEL_SCAN_H_ */
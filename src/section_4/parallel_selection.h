@@ -0,0 +1,122 @@
+#ifndef PARALLEL_SELECTION_H_
+#define PARALLEL_SELECTION_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include "execution_policy.h"
+#include "parallel_partition.h"
+#include "parallel_reduce.h"
+#include "parallel_sort.h"
+
+// ===================================================================
+// Parallel selection: nth_element, partial_sort and top-k
+// ===================================================================
+// parallel_nth_element is a quickselect on parallel_partition3: every
+// round partitions the remaining range around a sampled pivot, and keeps
+// only the side holding nth. Each round touches a fraction of the previous
+// one, so the total work is linear. Small ranges finish with
+// std::nth_element.
+//
+// parallel_partial_sort selects the first (middle - first) elements with
+// parallel_nth_element, and sorts only those with parallel_sort.
+//
+// parallel_top_k does not modify the input: every block keeps its k best
+// elements in a heap (parallel_map_reduce), and the heaps are merged. Only
+// worth it for small k, since every block holds k elements.
+//
+// On cancellation, the results are unspecified.
+namespace parallel_selection_detail {
+
+constexpr std::ptrdiff_t min_parallel_size = 256 * 1024;
+
+} // namespace parallel_selection_detail
+
+template <typename RandomIt, typename Compare>
+void parallel_nth_element(execution_policy const &policy, RandomIt first,
+                          RandomIt nth, RandomIt last, Compare comp) {
+  using namespace parallel_selection_detail;
+  if (nth == last) {
+    return;
+  }
+  // bounded number of rounds, as in introsort.
+  int depth_limit = parallel_sort_detail::max_depth(last - first);
+  while (last - first > min_parallel_size && depth_limit-- > 0) {
+    auto const [lower, upper] = parallel_partition3(
+        policy, first, last,
+        parallel_partition_detail::sample_pivot(first, last, comp), comp);
+    if (policy.stop_requested()) {
+      return;
+    }
+    if (nth < lower) {
+      last = lower;
+    } else if (nth < upper) {
+      return; // nth is equal to the pivot
+    } else {
+      first = upper;
+    }
+  }
+  std::nth_element(first, nth, last, comp);
+}
+
+template <typename RandomIt>
+void parallel_nth_element(execution_policy const &policy, RandomIt first,
+                          RandomIt nth, RandomIt last) {
+  parallel_nth_element(policy, first, nth, last, std::less<>());
+}
+
+template <typename RandomIt, typename Compare>
+void parallel_partial_sort(execution_policy const &policy, RandomIt first,
+                           RandomIt middle, RandomIt last, Compare comp) {
+  if (first == middle) {
+    return;
+  }
+  parallel_nth_element(policy, first, middle, last, comp);
+  parallel_sort(policy, first, middle, comp);
+}
+
+template <typename RandomIt>
+void parallel_partial_sort(execution_policy const &policy, RandomIt first,
+                           RandomIt middle, RandomIt last) {
+  parallel_partial_sort(policy, first, middle, last, std::less<>());
+}
+
+// Returns the k largest elements (according to comp), largest first.
+template <typename RandomIt, typename Compare = std::less<>>
+std::vector<std::iter_value_t<RandomIt>>
+parallel_top_k(execution_policy const &policy, RandomIt first, RandomIt last,
+               std::size_t k, Compare comp = Compare()) {
+  using T = std::iter_value_t<RandomIt>;
+  if (k == 0) {
+    return {};
+  }
+  // min-heap: the smallest kept element is on top, to be replaced.
+  auto const heap_comp = [&comp](T const &a, T const &b) {
+    return comp(b, a);
+  };
+  auto const push = [&](std::vector<T> &heap, T const &value) {
+    if (heap.size() < k) {
+      heap.push_back(value);
+      std::push_heap(heap.begin(), heap.end(), heap_comp);
+    } else if (comp(heap.front(), value)) {
+      std::pop_heap(heap.begin(), heap.end(), heap_comp);
+      heap.back() = value;
+      std::push_heap(heap.begin(), heap.end(), heap_comp);
+    }
+  };
+
+  std::vector<T> heap = parallel_map_reduce(
+      policy, first, last, std::vector<T>(), push,
+      [&](std::vector<T> &state, std::vector<T> &&other) {
+        for (T const &value : other) {
+          push(state, value);
+        }
+      });
+  std::sort_heap(heap.begin(), heap.end(), heap_comp);
+  return heap;
+}
+
+#endif /* PARALLEL_SELECTION_H_ */
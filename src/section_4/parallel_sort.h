@@ -0,0 +1,212 @@
+#ifndef PARALLEL_SORT_H_
+#define PARALLEL_SORT_H_
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <utility>
+
+#include "execution_policy.h"
+#include "parallel_partition.h"
+
+// ===================================================================
+// Parallel quicksort over random access ranges
+// ===================================================================
+// Unlike parallel_quick_sort on std::list (02_quicksort.cpp), this version
+// partitions the elements in place, so every level streams through
+// contiguous memory instead of chasing list nodes.
+// - Small ranges are finished with insertion sort.
+// - Ranges smaller than the grain size are sorted sequentially, so tasks
+//   are only created while there is enough work to share.
+// - The upper partition is submitted to the pool, the lower one is sorted
+//   by the current thread. Waiting threads run other pending tasks.
+// - Recursion depth is bounded (introsort), falling back to heap sort on
+//   adversarial inputs.
+// - At the top of the recursion, where there are fewer ranges than
+//   threads, a sequential partition would leave the other threads idle:
+//   ranges larger than the partition size are split with a parallel three
+//   way partition (parallel_partition.h) instead.
+// The chunk size hint of the policy sets the grain size. On cancellation,
+// the ranges not split yet are left unsorted.
+namespace parallel_sort_detail {
+
+constexpr std::ptrdiff_t insertion_sort_cutoff = 32;
+constexpr std::ptrdiff_t min_grain_size = 16 * 1024;
+constexpr std::ptrdiff_t min_parallel_partition_size = 1024 * 1024;
+
+template <typename RandomIt, typename Compare>
+void insertion_sort(RandomIt first, RandomIt last, Compare &comp) {
+  if (first == last) {
+    return;
+  }
+  for (RandomIt i = std::next(first); i != last; ++i) {
+    auto value = std::move(*i);
+    RandomIt j = i;
+    for (; j != first && comp(value, *std::prev(j)); --j) {
+      *j = std::move(*std::prev(j));
+    }
+    *j = std::move(value);
+  }
+}
+
+// Moves the median of first, middle and last - 1 into first, and returns
+// the partition point of a Hoare partition around it. Needs at least 3
+// elements: the median of 3 provides the sentinels of the inner loops.
+template <typename RandomIt, typename Compare>
+RandomIt hoare_partition(RandomIt first, RandomIt last, Compare &comp) {
+  RandomIt const mid = first + (last - first) / 2;
+  RandomIt const back = last - 1;
+  if (comp(*mid, *first)) {
+    std::iter_swap(mid, first);
+  }
+  if (comp(*back, *mid)) {
+    std::iter_swap(back, mid);
+    if (comp(*mid, *first)) {
+      std::iter_swap(mid, first);
+    }
+  }
+  // first <= mid <= back: the sentinels keep the inner loops in range.
+  std::iter_swap(first, mid);
+  auto const &pivot = *first;
+
+  RandomIt lo = first;
+  RandomIt hi = last;
+  while (true) {
+    do {
+      ++lo;
+    } while (comp(*lo, pivot));
+    do {
+      --hi;
+    } while (comp(pivot, *hi));
+    if (lo >= hi) {
+      break;
+    }
+    std::iter_swap(lo, hi);
+  }
+  std::iter_swap(first, hi);
+  return hi;
+}
+
+template <typename RandomIt, typename Compare>
+void sequential_sort(RandomIt first, RandomIt last, Compare &comp,
+                     int depth_limit) {
+  while (last - first > insertion_sort_cutoff) {
+    if (depth_limit-- == 0) {
+      std::make_heap(first, last, comp);
+      std::sort_heap(first, last, comp);
+      return;
+    }
+    RandomIt const cut = hoare_partition(first, last, comp);
+    // recurse on the smaller side, loop on the larger one.
+    if (cut - first < last - cut) {
+      sequential_sort(first, cut, comp, depth_limit);
+      first = cut + 1;
+    } else {
+      sequential_sort(cut + 1, last, comp, depth_limit);
+      last = cut;
+    }
+  }
+  insertion_sort(first, last, comp);
+}
+
+// Splits [first, last) into [first, lower) and [upper, last), around a
+// pivot in [lower, upper).
+template <typename RandomIt, typename Compare>
+std::pair<RandomIt, RandomIt>
+split(execution_policy const &policy, RandomIt first, RandomIt last,
+      Compare &comp, std::ptrdiff_t partition_size) {
+  if constexpr (std::copy_constructible<std::iter_value_t<RandomIt>>) {
+    if (last - first > partition_size) {
+      return parallel_partition3(
+          policy, first, last,
+          parallel_partition_detail::sample_pivot(first, last, comp), comp);
+    }
+  }
+  RandomIt const cut = hoare_partition(first, last, comp);
+  return {cut, cut + 1};
+}
+
+template <typename RandomIt, typename Compare>
+void parallel_sort_impl(execution_policy const &policy, RandomIt first,
+                        RandomIt last, Compare &comp,
+                        std::ptrdiff_t grain_size,
+                        std::ptrdiff_t partition_size, int depth_limit) {
+  while (last - first > grain_size) {
+    if (policy.stop_requested()) {
+      return;
+    }
+    if (depth_limit-- == 0) {
+      sequential_sort(first, last, comp, 0);
+      return;
+    }
+    auto const [lower, upper] =
+        split(policy, first, last, comp, partition_size);
+
+    // Divide and conquer: the upper part goes to the pool.
+    thread_pool &pool = policy.pool;
+    std::future<void> upper_task =
+        pool.submit([&policy, upper, last, &comp, grain_size,
+                     partition_size, depth_limit]() {
+          parallel_sort_impl(policy, upper, last, comp, grain_size,
+                             partition_size, depth_limit);
+        });
+    try {
+      parallel_sort_impl(policy, first, lower, comp, grain_size,
+                         partition_size, depth_limit);
+    } catch (...) {
+      pool.wait(upper_task); // comp is shared with the upper task
+      throw;
+    }
+    pool.wait(upper_task);
+    upper_task.get();
+    return;
+  }
+  sequential_sort(first, last, comp, depth_limit);
+}
+
+inline int max_depth(std::ptrdiff_t length) {
+  int depth = 0;
+  for (; length > 1; length >>= 1) {
+    ++depth;
+  }
+  return 2 * depth;
+}
+
+} // namespace parallel_sort_detail
+
+template <typename RandomIt, typename Compare>
+void parallel_sort(execution_policy const &policy, RandomIt first,
+                   RandomIt last, Compare comp) {
+  std::ptrdiff_t const length = last - first;
+  if (length < 2) {
+    return;
+  }
+
+  // about 8 tasks per thread, enough to balance uneven partitions. Never
+  // below the insertion sort cutoff: smaller ranges are not partitioned.
+  std::ptrdiff_t const grain_size =
+      policy.chunk_size != 0
+          ? std::max(static_cast<std::ptrdiff_t>(policy.chunk_size),
+                     parallel_sort_detail::insertion_sort_cutoff)
+          : std::max(parallel_sort_detail::min_grain_size,
+                     length / static_cast<std::ptrdiff_t>(
+                                  8 * policy.pool.size()));
+  // parallel partitions until there is a range per thread.
+  std::ptrdiff_t const partition_size = std::max(
+      parallel_sort_detail::min_parallel_partition_size,
+      length / static_cast<std::ptrdiff_t>(policy.concurrency()));
+  parallel_sort_detail::parallel_sort_impl(
+      policy, first, last, comp, grain_size, partition_size,
+      parallel_sort_detail::max_depth(length));
+}
+
+template <typename RandomIt>
+void parallel_sort(execution_policy const &policy, RandomIt first,
+                   RandomIt last) {
+  parallel_sort(policy, first, last, std::less<>());
+}
+
+#endif /* PARALLEL_SORT_H_ */
@@ -0,0 +1,171 @@
+#ifndef RADIX_SORT_H_
+#define RADIX_SORT_H_
+
+#include <array>
+#include <bit>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "block_partition.h"
+#include "execution_policy.h"
+#include "section_6/spin_hints.h"
+
+// ===================================================================
+// Parallel LSD radix sort for integers and floating point numbers
+// ===================================================================
+// Sorts 8 bits per pass, from the least to the most significant byte.
+// Every pass:
+// 1. Each thread counts the digits of its block (per-thread histograms,
+//    no shared counters).
+// 2. The histograms are prefix-summed in (digit, block) order, so each
+//    thread knows the exact output offset of every digit in its block.
+// 3. Each thread scatters its block. Elements are first collected into a
+//    small cache-line sized buffer per digit (software write-combining) and
+//    copied out a full line at a time, instead of touching 256 different
+//    output locations element by element.
+// Passes where every element has the same digit are skipped.
+//
+// Keys of up to 64 bits (so not long double) are mapped to unsigned
+// integers preserving the order:
+// - signed integers: flip the sign bit.
+// - IEEE floats: flip the sign bit of positives, and every bit of negatives.
+//   -0.0 sorts before +0.0, and NaNs go to the ends according to their sign.
+//
+// On cancellation, the keys are left sorted by the completed passes only.
+namespace radix_sort_detail {
+
+constexpr unsigned digit_bits = 8;
+constexpr std::size_t radix = std::size_t(1) << digit_bits;
+constexpr std::size_t min_block_size = 64 * 1024;
+using spin_hints::cache_line_size;
+
+template <typename T>
+using key_type = std::conditional_t<
+    sizeof(T) == 1, std::uint8_t,
+    std::conditional_t<
+        sizeof(T) == 2, std::uint16_t,
+        std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+
+template <typename T> key_type<T> to_key(T value) {
+  using key = key_type<T>;
+  constexpr key sign_bit = key(1) << (sizeof(T) * CHAR_BIT - 1);
+  if constexpr (std::is_floating_point_v<T>) {
+    key const bits = std::bit_cast<key>(value);
+    return (bits & sign_bit) ? key(~bits) : key(bits | sign_bit);
+  } else if constexpr (std::is_signed_v<T>) {
+    return static_cast<key>(value) ^ sign_bit;
+  } else {
+    return value;
+  }
+}
+
+template <typename T> std::size_t digit(T value, unsigned pass) {
+  return (to_key(value) >> (pass * digit_bits)) & (radix - 1);
+}
+
+using histogram = std::array<std::size_t, radix>;
+
+// Scatters [in, in + count) into out, starting each digit at offsets[d].
+template <typename T>
+void scatter(T const *in, std::size_t count, T *out, histogram offsets,
+             unsigned pass) {
+  constexpr std::size_t line = cache_line_size / sizeof(T);
+  struct alignas(cache_line_size) line_buffer {
+    T values[line];
+  };
+  // 256 lines: 16KB, fits in L1.
+  std::unique_ptr<line_buffer[]> buffers(new line_buffer[radix]);
+  std::array<unsigned char, radix> fill{};
+
+  for (std::size_t i = 0; i < count; ++i) {
+    T const value = in[i];
+    std::size_t const d = digit(value, pass);
+    buffers[d].values[fill[d]++] = value;
+    if (fill[d] == line) {
+      std::memcpy(out + offsets[d], buffers[d].values, sizeof(T) * line);
+      offsets[d] += line;
+      fill[d] = 0;
+    }
+  }
+
+  // flush partially filled lines.
+  for (std::size_t d = 0; d < radix; ++d) {
+    std::memcpy(out + offsets[d], buffers[d].values, sizeof(T) * fill[d]);
+  }
+}
+
+} // namespace radix_sort_detail
+
+template <typename ContiguousIt>
+  requires std::contiguous_iterator<ContiguousIt> &&
+           std::is_arithmetic_v<std::iter_value_t<ContiguousIt>> &&
+           (sizeof(std::iter_value_t<ContiguousIt>) <= 8)
+void parallel_radix_sort(execution_policy const &policy, ContiguousIt first,
+                         ContiguousIt last) {
+  using namespace radix_sort_detail;
+  using T = std::iter_value_t<ContiguousIt>;
+  static_assert(!std::is_same_v<T, bool>, "bool keys are not supported");
+
+  std::size_t const length = last - first;
+  if (length < 2) {
+    return;
+  }
+
+  T *data = std::to_address(first);
+  std::vector<T> buffer(length);
+  T *in = data;
+  T *out = buffer.data();
+
+  block_partition const blocks(length, policy.concurrency(),
+                               policy.chunk_size_or(min_block_size));
+  std::vector<histogram> histograms(blocks.num_blocks);
+
+  for (unsigned pass = 0; pass < sizeof(T); ++pass) {
+    // 1. per-thread histograms
+    policy.fork_join(blocks.num_blocks, [&](std::size_t b) {
+      histogram &h = histograms[b];
+      h.fill(0);
+      for (std::size_t i = blocks.begin(b); i < blocks.end(b); ++i) {
+        ++h[digit(in[i], pass)];
+      }
+    });
+    if (policy.stop_requested()) {
+      break;
+    }
+
+    // 2. prefix sum in (digit, block) order: the output offsets
+    std::size_t offset = 0;
+    bool single_digit = false;
+    for (std::size_t d = 0; d < radix; ++d) {
+      std::size_t const digit_start = offset;
+      for (auto &h : histograms) {
+        std::size_t const count = h[d];
+        h[d] = offset;
+        offset += count;
+      }
+      single_digit = single_digit || (offset - digit_start == length);
+    }
+    if (single_digit) {
+      continue; // this byte is the same for every key
+    }
+
+    // 3. scatter (not cancelled: every block is needed in the output)
+    policy.pool.fork_join(blocks.num_blocks, [&](std::size_t b) {
+      scatter(in + blocks.begin(b), blocks.size(b), out, histograms[b],
+              pass);
+    });
+    std::swap(in, out);
+  }
+
+  if (in != data) {
+    std::memcpy(data, in, sizeof(T) * length);
+  }
+}
+
+#endif /* RADIX_SORT_H_ */
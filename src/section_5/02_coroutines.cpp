@@ -35,7 +35,7 @@ struct resumable::promise_type {
   auto get_return_object() { return co_handle::from_promise(*this); }
 
   auto initial_suspend() { return std::suspend_always(); }
-  auto final_suspend() { return std::suspend_always(); }
+  auto final_suspend() noexcept { return std::suspend_always(); }
   void return_void() {}
   void unhandled_exception() { std::terminate(); }
 };
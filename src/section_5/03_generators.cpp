@@ -1,68 +1,189 @@
-#include <cassert>
-#include <coroutine>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
-#include <exception>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
+#include <string>
+
+#include "generator.h"
+
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results, as values per second.
+void print_results(const char *const tag, std::size_t count, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  double const seconds = duration<double>(endTime - startTime).count();
+  printf("%s: %12.0f /s %s\n", tag, count / seconds,
+         correct ? "" : "WRONG RESULT");
+}
+
+Generator<int> genInts(int start = 0, int step = 1) noexcept {
+  auto value = start;
+  for (int i = 0;; ++i) {
+    co_yield value;
+    value += step;
+  }
+}
 
 // ===================================================================
-// User defined Generator type and promise_types.
+// Examples
 // ===================================================================
+static_assert(std::ranges::input_range<Generator<int>>);
 
-template <typename T> class Generator {
-public:
-  struct promise_type;
-
-  using co_handle = std::coroutine_handle<promise_type>;
+void examples() {
+  // next() / getValue()
+  auto gen = genInts();
+  for (int i = 0; i <= 10; ++i) {
+    gen.next();
+    printf("Generating integer: %d\n", gen.getValue());
+  }
 
-  Generator(co_handle handle) : handle_(handle) {}
-  ~Generator() { handle_.destroy(); }
-  Generator(Generator &) = delete;
-  Generator(Generator &&) = delete;
+  // range-for, and std::ranges views
+  printf("Odd squares:");
+  for (int v : genInts(1) | std::views::filter([](int v) { return v % 2; }) |
+                   std::views::transform([](int v) { return v * v; }) |
+                   std::views::take(5)) {
+    printf(" %d", v);
+  }
+  printf("\n");
 
-  T getValue() { return handle_.promise().current_value; }
+  // generators are movable.
+  Generator<int> moved = genInts(100, 100);
+  Generator<int> owner = std::move(moved);
+  owner.next();
+  printf("Moved generator: %d\n", owner.getValue());
+}
 
-  bool next() {
-    handle_.resume();
-    return not handle_.done();
+// ===================================================================
+// Benchmark: values per second
+// ===================================================================
+Generator<std::uint64_t> genRange(std::uint64_t count) {
+  for (std::uint64_t i = 0; i < count; ++i) {
+    co_yield i;
   }
+}
+
+// Hand-written equivalent of genRange: a counting iterator.
+class counting_range {
+  std::uint64_t count;
+
+public:
+  struct iterator {
+    std::uint64_t i;
+    std::uint64_t operator*() const { return i; }
+    iterator &operator++() {
+      ++i;
+      return *this;
+    }
+    bool operator==(iterator const &) const = default;
+  };
 
-private:
-  co_handle handle_;
+  explicit counting_range(std::uint64_t _count) : count(_count) {}
+  iterator begin() const { return {0}; }
+  iterator end() const { return {count}; }
 };
 
-template <typename T> struct Generator<T>::promise_type {
-  using co_handle = std::coroutine_handle<promise_type>;
+// Large values are yielded by reference: no copy per value.
+struct big {
+  std::array<std::uint64_t, 128> data{}; // 1KB
+};
 
-  auto get_return_object() { return co_handle::from_promise(*this); }
+Generator<big> genBig(std::uint64_t count) {
+  big value;
+  for (std::uint64_t i = 0; i < count; ++i) {
+    value.data[i % value.data.size()] = i;
+    co_yield value;
+  }
+}
 
-  auto initial_suspend() { return std::suspend_always(); }
-  auto final_suspend() { return std::suspend_always(); }
-  void return_void() {}
-  void unhandled_exception() { std::terminate(); }
+void values_per_second(std::uint64_t count) {
+  printf("\nIterating %lu values...\n", count);
+  std::uint64_t const expected = count * (count - 1) / 2;
 
-  // enable co_yield operator
-  auto yield_value(const T value) {
-    current_value = value;
-    return std::suspend_always();
+  auto startTime = high_resolution_clock::now();
+  std::uint64_t sum = 0;
+  for (std::uint64_t v : counting_range(count)) {
+    sum += v;
   }
+  auto endTime = high_resolution_clock::now();
+  print_results("hand-written iterator ", count, sum == expected, startTime,
+                endTime);
 
-  T current_value;
-};
+  startTime = high_resolution_clock::now();
+  sum = 0;
+  for (std::uint64_t v : genRange(count)) {
+    sum += v;
+  }
+  endTime = high_resolution_clock::now();
+  print_results("Generator range-for   ", count, sum == expected, startTime,
+                endTime);
+
+  startTime = high_resolution_clock::now();
+  sum = 0;
+  for (big const &v : genBig(count)) {
+    sum += v.data[sum % 2]; // touch the value
+  }
+  endTime = high_resolution_clock::now();
+  print_results("Generator<1KB struct> ", count, true, startTime, endTime);
+}
+
+// ===================================================================
+// Benchmark: frames from an arena
 // ===================================================================
+Generator<int> genFew(std::allocator_arg_t, std::pmr::memory_resource &,
+                     int count) {
+  for (int i = 0; i < count; ++i) {
+    co_yield i;
+  }
+}
 
-Generator<int> genInts(int start = 0, int step = 1) noexcept {
-  auto value = start;
-  for (int i = 0;; ++i) {
-    co_yield value;
-    value += step;
+Generator<int> genFew(int count) {
+  for (int i = 0; i < count; ++i) {
+    co_yield i;
   }
 }
 
-int main() {
-  auto gen = genInts();
-  for (int i = 0; i <= 10; ++i) {
-    gen.next();
-    printf("Generating integer: %d\n", gen.getValue());
+void frames_per_second(std::size_t count) {
+  printf("\nCreating %zu short generators...\n", count);
+  long const expected = static_cast<long>(count) * 6; // 0 + 1 + 2 + 3
+
+  auto startTime = high_resolution_clock::now();
+  long sum = 0;
+  for (std::size_t g = 0; g < count; ++g) {
+    for (int v : genFew(4)) {
+      sum += v;
+    }
+  }
+  auto endTime = high_resolution_clock::now();
+  print_results("heap frames           ", count, sum == expected, startTime,
+                endTime);
+
+  // one stack buffer, reused by every generator.
+  alignas(std::max_align_t) std::byte buffer[1024];
+  startTime = high_resolution_clock::now();
+  sum = 0;
+  for (std::size_t g = 0; g < count; ++g) {
+    std::pmr::monotonic_buffer_resource arena(
+        buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    for (int v : genFew(std::allocator_arg, arena, 4)) {
+      sum += v;
+    }
   }
+  endTime = high_resolution_clock::now();
+  print_results("arena frames          ", count, sum == expected, startTime,
+                endTime);
+}
+
+int main(int argc, char **argv) {
+  const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 100'000'000;
 
+  examples();
+  values_per_second(count);
+  frames_per_second(count / 10);
   return 0;
 }
@@ -0,0 +1,152 @@
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "section_8/thread_pool.h"
+#include "task.h"
+
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results, as time per switch.
+void print_results(const char *const tag, std::size_t switches,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  double const ns =
+      duration<double, std::nano>(endTime - startTime).count() / switches;
+  printf("%s: %10.1f ns per switch\n", tag, ns);
+}
+
+// ===================================================================
+// EXAMPLE 1: values and exceptions
+// ===================================================================
+task<int> add(int a, int b) { co_return a + b; }
+
+task<int> fail() {
+  throw std::runtime_error("failed in a nested task");
+  co_return 0;
+}
+
+task<int> compute() {
+  int const x = co_await add(1, 2);
+  int const y = co_await add(x, 10);
+  try {
+    co_await fail();
+  } catch (std::exception const &e) {
+    printf("caught: %s\n", e.what());
+  }
+  co_return x + y;
+}
+
+// ===================================================================
+// EXAMPLE 2: no stack growth
+// ===================================================================
+// A million nested tasks: every level is started and completed by
+// symmetric transfer, so the stack stays one frame deep. gcc only emits
+// the tail call when optimizing: unoptimized builds go less deep.
+#ifdef __OPTIMIZE__
+const std::size_t max_depth = 1'000'000;
+#else
+const std::size_t max_depth = 10'000;
+#endif
+
+task<std::size_t> depth(std::size_t n) {
+  if (n == 0) {
+    co_return 0;
+  }
+  co_return 1 + co_await depth(n - 1);
+}
+
+// ===================================================================
+// Benchmark: coroutine switches versus thread handoffs
+// ===================================================================
+// A task that completes synchronously: one frame, and two switches (into
+// the task and back).
+task<std::size_t> identity(std::size_t i) { co_return i; }
+
+task<std::size_t> await_loop(std::size_t count) {
+  std::size_t sum = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    sum += co_await identity(i);
+  }
+  co_return sum;
+}
+
+// Every co_await moves the coroutine to the pool queue, and a worker
+// resumes it.
+task<std::size_t> hop_loop(thread_pool &pool, std::size_t count) {
+  std::size_t hops = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    co_await pool.schedule();
+    ++hops;
+  }
+  co_return hops;
+}
+
+void switch_cost(thread_pool &pool, std::size_t count) {
+  printf("\nSwitch cost, %zu switches...\n", count);
+
+  auto startTime = high_resolution_clock::now();
+  std::size_t const sum = sync_wait(await_loop(count));
+  auto endTime = high_resolution_clock::now();
+  print_results("co_await task (same thread)  ", 2 * count, startTime,
+                endTime);
+  if (sum != count * (count - 1) / 2) {
+    printf("WRONG RESULT\n");
+  }
+
+  startTime = high_resolution_clock::now();
+  sync_wait(hop_loop(pool, count));
+  endTime = high_resolution_clock::now();
+  print_results("co_await pool.schedule()     ", count, startTime, endTime);
+
+  // round trip: to a worker and back.
+  startTime = high_resolution_clock::now();
+  for (std::size_t i = 0; i < count; ++i) {
+    pool.submit([] {}).get();
+  }
+  endTime = high_resolution_clock::now();
+  print_results("pool.submit().get()          ", 2 * count, startTime,
+                endTime);
+
+  // ping-pong between two threads, a new promise for every handoff.
+  startTime = high_resolution_clock::now();
+  {
+    std::promise<void> ping;
+    std::future<void> ping_future = ping.get_future();
+    std::promise<void> pong;
+    std::future<void> pong_future = pong.get_future();
+    std::thread other([&] {
+      for (std::size_t i = 0; i < count; ++i) {
+        ping_future.get();
+        ping_future = (ping = std::promise<void>()).get_future();
+        std::promise<void> answer = std::exchange(pong, {});
+        answer.set_value();
+      }
+    });
+    for (std::size_t i = 0; i < count; ++i) {
+      std::promise<void> request = std::exchange(ping, {});
+      request.set_value();
+      pong_future.get();
+      pong_future = (pong = std::promise<void>()).get_future();
+    }
+    other.join();
+  }
+  endTime = high_resolution_clock::now();
+  print_results("promise/future ping-pong     ", 2 * count, startTime,
+                endTime);
+}
+
+int main(int argc, char **argv) {
+  const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+  thread_pool pool;
+
+  printf("compute() = %d\n", sync_wait(compute()));
+  printf("depth(%zu) = %zu\n", max_depth, sync_wait(depth(max_depth)));
+  switch_cost(pool, count);
+  return 0;
+}
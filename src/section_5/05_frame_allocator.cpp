@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "frame_allocator.h"
+#include "generator.h"
+#include "task.h"
+
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results, as coroutines per second.
+void print_results(const char *const tag, std::size_t count, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  double const seconds = duration<double>(endTime - startTime).count();
+  printf("%s: %12.0f coroutines/s %s\n", tag, count / seconds,
+         correct ? "" : "WRONG RESULT");
+}
+
+// ===================================================================
+// resumable (02_coroutines.cpp), with a frame allocator and movable.
+// ===================================================================
+template <typename FrameAllocator> class resumable {
+public:
+  struct promise_type : FrameAllocator {
+    using co_handle = std::coroutine_handle<promise_type>;
+
+    auto get_return_object() { return co_handle::from_promise(*this); }
+
+    auto initial_suspend() { return std::suspend_always(); }
+    auto final_suspend() noexcept { return std::suspend_always(); }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  using co_handle = std::coroutine_handle<promise_type>;
+
+  resumable(co_handle handle) : handle_(handle) { assert(handle); }
+  resumable(resumable &&other) noexcept
+      : handle_(std::exchange(other.handle_, {})) {}
+  ~resumable() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+  resumable(resumable const &) = delete;
+
+  bool resume() {
+    if (not handle_.done()) {
+      handle_.resume();
+    }
+    return not handle_.done();
+  }
+
+private:
+  co_handle handle_;
+};
+
+template <typename FrameAllocator>
+resumable<FrameAllocator> foo(std::size_t &counter) {
+  ++counter;
+  co_await std::suspend_always();
+  ++counter;
+}
+
+template <typename FrameAllocator>
+Generator<int, FrameAllocator> genFew(int count) {
+  for (int i = 0; i < count; ++i) {
+    co_yield i;
+  }
+}
+
+template <typename FrameAllocator>
+task<std::size_t, FrameAllocator> identity(std::size_t i) {
+  co_return i;
+}
+
+template <typename FrameAllocator>
+task<std::size_t, FrameAllocator> await_loop(std::size_t count) {
+  std::size_t sum = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    sum += co_await identity<FrameAllocator>(i);
+  }
+  co_return sum;
+}
+
+// ===================================================================
+// Benchmarks: create, run and destroy short coroutines
+// ===================================================================
+template <typename FrameAllocator>
+void run_all(const char *const name, std::size_t count) {
+  std::string tag = std::string("resumable ") + name;
+  auto startTime = high_resolution_clock::now();
+  std::size_t counter = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    resumable<FrameAllocator> r = foo<FrameAllocator>(counter);
+    while (r.resume()) {
+    }
+  }
+  auto endTime = high_resolution_clock::now();
+  print_results(tag.c_str(), count, counter == 2 * count, startTime,
+                endTime);
+
+  tag = std::string("Generator ") + name;
+  startTime = high_resolution_clock::now();
+  long sum = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    for (int v : genFew<FrameAllocator>(4)) {
+      sum += v;
+    }
+  }
+  endTime = high_resolution_clock::now();
+  print_results(tag.c_str(), count, sum == 6 * static_cast<long>(count),
+                startTime, endTime);
+
+  tag = std::string("task      ") + name;
+  startTime = high_resolution_clock::now();
+  std::size_t const total = sync_wait(await_loop<FrameAllocator>(count));
+  endTime = high_resolution_clock::now();
+  print_results(tag.c_str(), count, total == count * (count - 1) / 2,
+                startTime, endTime);
+}
+
+// Frames created on one thread, destroyed on another: the recycling
+// allocator sends them back to the cache of the creating thread.
+template <typename FrameAllocator>
+void cross_thread(const char *const name, std::size_t count) {
+  constexpr std::size_t batch_size = 1024;
+  using batch = std::vector<resumable<FrameAllocator>>;
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<batch> queue;
+  std::size_t counter = 0;
+
+  auto startTime = high_resolution_clock::now();
+  std::thread consumer([&] {
+    for (std::size_t done = 0; done < count;) {
+      batch frames;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return !queue.empty(); });
+        frames = std::move(queue.front());
+        queue.pop_front();
+      }
+      cv.notify_one();
+      done += frames.size();
+    } // frames destroyed here
+  });
+  for (std::size_t i = 0; i < count; i += batch_size) {
+    batch frames;
+    for (std::size_t j = i; j < std::min(count, i + batch_size); ++j) {
+      frames.push_back(foo<FrameAllocator>(counter));
+      frames.back().resume();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return queue.size() < 4; }); // bounded
+    queue.push_back(std::move(frames));
+    cv.notify_one();
+  }
+  consumer.join();
+  auto endTime = high_resolution_clock::now();
+  std::string const tag = std::string("cross-thread ") + name;
+  print_results(tag.c_str(), count, counter == count, startTime, endTime);
+}
+
+int main(int argc, char **argv) {
+  const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 10'000'000;
+
+  printf("\nCreating %zu coroutines of every kind...\n", count);
+  run_all<default_frame_allocator>("default  ", count);
+  run_all<recycling_frame_allocator>("recycling", count);
+
+  printf("\nCreating %zu coroutines, destroyed on another thread...\n",
+         count);
+  cross_thread<default_frame_allocator>("default  ", count);
+  cross_thread<recycling_frame_allocator>("recycling", count);
+  return 0;
+}
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "async_generator.h"
+#include "section_8/thread_pool.h"
+#include "task.h"
+
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results, as records per second.
+void print_results(const char *const tag, std::size_t count, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  double const seconds = duration<double>(endTime - startTime).count();
+  printf("%s: %12.0f records/s %s\n", tag, count / seconds,
+         correct ? "" : "WRONG RESULT");
+}
+
+// ===================================================================
+// EXAMPLES
+// ===================================================================
+async_generator<int> numbers(thread_pool &pool, int count) {
+  for (int i = 0; i < count; ++i) {
+    if (i % 4 == 0) {
+      co_await pool.schedule(); // a producer can co_await between values
+    }
+    co_yield i;
+  }
+}
+
+task<int> lookup(int key) { co_return key * 10; }
+
+async_generator<int> broken() {
+  co_yield 1;
+  throw std::runtime_error("failed in a pipeline stage");
+}
+
+task<void> consume(thread_pool &pool) {
+  async_generator<int> gen = numbers(pool, 5);
+  printf("Consumed:");
+  while (std::optional<int> v = co_await gen.next()) {
+    printf(" %d", *v);
+  }
+  printf("\n");
+}
+
+void examples(thread_pool &pool) {
+  sync_wait(consume(pool));
+
+  // stages, the second one asynchronous, two of them on the pool.
+  printf("Pipeline:");
+  sync_wait(numbers(pool, 20) |
+            pipeline::filter([](int v) { return v % 3 == 0; }) |
+            pipeline::via(pool, 4) | pipeline::transform(lookup) |
+            pipeline::via(pool, 4) |
+            pipeline::for_each([](int v) { printf(" %d", v); }));
+  printf("\n");
+
+  // exceptions reach the sink, through the buffers.
+  try {
+    sync_wait(broken() | pipeline::via(pool, 4) |
+              pipeline::for_each([](int) {}));
+  } catch (std::exception const &e) {
+    printf("caught: %s\n", e.what());
+  }
+}
+
+// ===================================================================
+// BENCHMARK: an ETL pipeline
+// ===================================================================
+// extract (source) -> parse (transform) -> validate (filter)
+//                  -> enrich (transform) -> load (sink)
+// Every stage does the same amount of work per record.
+struct record {
+  std::uint64_t id;
+  std::uint64_t value;
+};
+
+constexpr int rounds = 16;
+
+std::uint64_t work(std::uint64_t x) {
+  for (int i = 0; i < rounds; ++i) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+  }
+  return x;
+}
+
+record parse(record r) { return {r.id, work(r.value)}; }
+bool validate(record const &r) { return work(r.value) % 4 != 0; }
+record enrich(record r) { return {r.id, work(r.value) & 0xffff}; }
+
+// Records extracted but neither dropped nor loaded yet, sampled by the
+// sink: shows the backpressure.
+struct in_flight {
+  std::atomic<std::size_t> extracted{0};
+  std::atomic<std::size_t> finished{0};
+  std::size_t max = 0;
+};
+
+async_generator<record> extract(std::size_t count, in_flight &stats) {
+  for (std::size_t i = 0; i < count; ++i) {
+    stats.extracted.fetch_add(1, std::memory_order_relaxed);
+    co_yield record{i, work(i)};
+  }
+}
+
+struct validator {
+  in_flight &stats;
+
+  bool operator()(record const &r) const {
+    bool const valid = validate(r);
+    if (!valid) {
+      stats.finished.fetch_add(1, std::memory_order_relaxed);
+    }
+    return valid;
+  }
+};
+
+struct loader {
+  std::uint64_t &sum;
+  in_flight &stats;
+
+  void operator()(record const &r) {
+    sum += r.value;
+    std::size_t const finished =
+        stats.finished.fetch_add(1, std::memory_order_relaxed) + 1;
+    std::size_t const extracted =
+        stats.extracted.load(std::memory_order_relaxed);
+    stats.max = std::max(stats.max, extracted - std::min(extracted, finished));
+  }
+};
+
+std::uint64_t reference(std::size_t count) {
+  std::uint64_t sum = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    record const r = parse(record{i, work(i)});
+    if (validate(r)) {
+      sum += enrich(r).value;
+    }
+  }
+  return sum;
+}
+
+void pipeline_throughput(std::size_t count, unsigned threads) {
+  printf("\nETL pipeline of 5 stages, %zu records...\n", count);
+  auto startTime = high_resolution_clock::now();
+  std::uint64_t const expected = reference(count);
+  auto endTime = high_resolution_clock::now();
+  print_results("plain loop               ", count, true, startTime, endTime);
+
+  {
+    in_flight stats;
+    std::uint64_t sum = 0;
+    startTime = high_resolution_clock::now();
+    sync_wait(extract(count, stats) | pipeline::transform(parse) |
+              pipeline::filter(validator{stats}) |
+              pipeline::transform(enrich) |
+              pipeline::for_each(loader{sum, stats}));
+    endTime = high_resolution_clock::now();
+    print_results("async_generator, 1 thread", count, sum == expected,
+                  startTime, endTime);
+  }
+
+  // every stage on its own coroutine, on a pool.
+  thread_pool pool(threads);
+  for (std::size_t capacity : {1, 16, 256}) {
+    in_flight stats;
+    std::uint64_t sum = 0;
+    startTime = high_resolution_clock::now();
+    sync_wait(extract(count, stats) | pipeline::via(pool, capacity) |
+              pipeline::transform(parse) | pipeline::via(pool, capacity) |
+              pipeline::filter(validator{stats}) |
+              pipeline::via(pool, capacity) | pipeline::transform(enrich) |
+              pipeline::via(pool, capacity) |
+              pipeline::for_each(loader{sum, stats}));
+    endTime = high_resolution_clock::now();
+    std::string tag = "4 buffers of " + std::to_string(capacity);
+    tag.resize(25, ' ');
+    print_results(tag.c_str(), count, sum == expected, startTime, endTime);
+    printf("  at most %zu records in flight\n", stats.max);
+  }
+}
+
+int main(int argc, char **argv) {
+  const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+  const unsigned threads =
+      argc > 2 ? std::stoul(argv[2]) : thread_pool::default_thread_count();
+
+  {
+    thread_pool pool(2);
+    examples(pool);
+  }
+  pipeline_throughput(count, threads);
+  return 0;
+}
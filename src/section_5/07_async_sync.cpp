@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+#include "async_sync.h"
+#include "section_8/thread_pool.h"
+#include "task.h"
+
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results, as lock acquisitions per second.
+void print_results(const char *const tag, std::size_t count, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  double const seconds = duration<double>(endTime - startTime).count();
+  printf("%s: %12.0f locks/s %s\n", tag, count / seconds,
+         correct ? "" : "WRONG RESULT");
+}
+
+// ===================================================================
+// Contending coroutines
+// ===================================================================
+// count coroutines start on the pool, and each one takes the lock
+// iterations times, moving back to the pool queue in between so that all
+// of them interleave. Every lock first tries without waiting: the failures
+// are the times a thread was blocked (std::mutex), or a coroutine was
+// suspended (async primitives). An async_latch tells when all are done.
+struct contention {
+  std::size_t counter = 0; // under the lock
+  std::atomic<std::size_t> waits{0};
+  std::atomic<std::size_t> holders{0};
+  std::atomic<std::size_t> max_holders{0};
+};
+
+constexpr std::size_t iterations = 10;
+
+task<void> wait_for(async_latch &latch) { co_await latch; }
+
+task<void> with_std_mutex(thread_pool &pool, std::mutex &mutex,
+                          contention &state, async_latch &done) {
+  for (std::size_t i = 0; i < iterations; ++i) {
+    co_await pool.schedule();
+    if (!mutex.try_lock()) {
+      state.waits.fetch_add(1, std::memory_order_relaxed);
+      mutex.lock(); // blocks the worker thread
+    }
+    ++state.counter;
+    mutex.unlock();
+  }
+  done.count_down();
+}
+
+// suspend_inside: the lock is held across a co_await, e.g. I/O. Not
+// possible with std::mutex, which must be unlocked by the thread that
+// locked it.
+task<void> with_async_mutex(thread_pool &pool, async_mutex &mutex,
+                            contention &state, async_latch &done,
+                            bool suspend_inside) {
+  for (std::size_t i = 0; i < iterations; ++i) {
+    co_await pool.schedule();
+    if (!mutex.try_lock()) {
+      state.waits.fetch_add(1, std::memory_order_relaxed);
+      co_await mutex.lock(); // suspends the coroutine only
+    }
+    ++state.counter;
+    if (suspend_inside) {
+      co_await pool.schedule();
+    }
+    mutex.unlock();
+  }
+  done.count_down();
+}
+
+// At most permits coroutines in the section, each suspended inside it.
+task<void> with_async_semaphore(thread_pool &pool, async_semaphore &semaphore,
+                                contention &state, async_latch &done) {
+  for (std::size_t i = 0; i < iterations; ++i) {
+    co_await pool.schedule();
+    if (!semaphore.try_acquire()) {
+      state.waits.fetch_add(1, std::memory_order_relaxed);
+      co_await semaphore.acquire();
+    }
+    std::size_t const holders =
+        state.holders.fetch_add(1, std::memory_order_relaxed) + 1;
+    std::size_t max = state.max_holders.load(std::memory_order_relaxed);
+    while (holders > max && !state.max_holders.compare_exchange_weak(
+                                max, holders, std::memory_order_relaxed)) {
+    }
+    co_await pool.schedule();
+    state.holders.fetch_sub(1, std::memory_order_relaxed);
+    semaphore.release();
+  }
+  done.count_down();
+}
+
+template <typename Spawn>
+void run(const char *const tag, thread_pool &pool, std::size_t count,
+         contention &state, Spawn spawn_one) {
+  async_latch done(pool, static_cast<std::ptrdiff_t>(count));
+  auto startTime = high_resolution_clock::now();
+  for (std::size_t i = 0; i < count; ++i) {
+    spawn(spawn_one(done));
+  }
+  sync_wait(wait_for(done));
+  auto endTime = high_resolution_clock::now();
+  bool const correct =
+      state.counter == 0 || state.counter == count * iterations;
+  print_results(tag, count * iterations, correct, startTime, endTime);
+}
+
+int main(int argc, char **argv) {
+  const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 100'000;
+  const unsigned threads = argc > 2 ? std::stoul(argv[2]) : 8;
+  constexpr std::ptrdiff_t permits = 4;
+
+  thread_pool pool(threads);
+  printf("\n%zu coroutines, %zu locks each, on %u threads...\n", count,
+         iterations, threads);
+
+  {
+    std::mutex mutex;
+    contention state;
+    run("std::mutex                   ", pool, count, state,
+        [&](async_latch &done) {
+          return with_std_mutex(pool, mutex, state, done);
+        });
+    printf("  %zu locks blocked a worker thread\n", state.waits.load());
+  }
+  {
+    async_mutex mutex(pool);
+    contention state;
+    run("async_mutex                  ", pool, count, state,
+        [&](async_latch &done) {
+          return with_async_mutex(pool, mutex, state, done, false);
+        });
+    printf("  %zu locks suspended a coroutine, none blocked a thread\n",
+           state.waits.load());
+  }
+  {
+    async_mutex mutex(pool);
+    contention state;
+    run("async_mutex, held across I/O ", pool, count, state,
+        [&](async_latch &done) {
+          return with_async_mutex(pool, mutex, state, done, true);
+        });
+    printf("  %zu locks suspended a coroutine, none blocked a thread\n",
+           state.waits.load());
+  }
+  {
+    async_semaphore semaphore(pool, permits);
+    contention state;
+    std::string const tag =
+        "async_semaphore(" + std::to_string(permits) + ")           ";
+    run(tag.c_str(), pool, count, state, [&](async_latch &done) {
+      return with_async_semaphore(pool, semaphore, state, done);
+    });
+    printf("  %zu acquires suspended a coroutine, at most %zu holders %s\n",
+           state.waits.load(), state.max_holders.load(),
+           state.max_holders.load() <= permits ? "" : "WRONG RESULT");
+  }
+  return 0;
+}
@@ -0,0 +1,243 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_sync.h"
+#include "channel.h"
+#include "section_8/thread_pool.h"
+#include "task.h"
+
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results, as time per message and messages per second.
+void print_results(const char *const tag, std::size_t messages,
+                   bool correct, high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  double const seconds = duration<double>(endTime - startTime).count();
+  printf("%s: %10.1f ns per message %12.0f messages/s %s\n", tag,
+         seconds * 1e9 / messages, messages / seconds,
+         correct ? "" : "WRONG RESULT");
+}
+
+// ===================================================================
+// EXAMPLES
+// ===================================================================
+// Workers take jobs from a shared channel until it is closed, and report
+// on another one.
+void workers() {
+  channel<int> jobs(4);
+  channel<std::string> results(4);
+  std::vector<std::thread> threads;
+  for (int w = 0; w < 3; ++w) {
+    threads.emplace_back([&jobs, &results, w] {
+      while (std::optional<int> job = jobs.recv()) {
+        results.send("worker " + std::to_string(w) + " did job " +
+                     std::to_string(*job));
+      }
+    });
+  }
+  std::thread printer([&results] {
+    while (std::optional<std::string> line = results.recv()) {
+      printf("%s\n", line->c_str());
+    }
+  });
+  for (int job = 0; job < 6; ++job) {
+    jobs.send(job);
+  }
+  jobs.close();
+  for (auto &t : threads) {
+    t.join();
+  }
+  results.close();
+  printer.join();
+}
+
+// select: the first channel with something to say.
+void selecting() {
+  channel<int> numbers(0);
+  channel<std::string> words(0);
+  channel<bool> quit(0);
+  std::thread sender([&] {
+    numbers.send(42);
+    words.send("hello");
+    quit.send(true);
+  });
+  for (bool done = false; !done;) {
+    select(on_recv(numbers, [](std::optional<int> v) {
+             printf("select: number %d\n", *v);
+           }),
+           on_recv(words, [](std::optional<std::string> v) {
+             printf("select: word %s\n", v->c_str());
+           }),
+           on_recv(quit, [&done](std::optional<bool>) {
+             printf("select: quit\n");
+             done = true;
+           }));
+  }
+  sender.join();
+}
+
+// A coroutine producer, a thread consumer.
+task<void> produce(thread_pool &pool, channel<int> &ch, int count) {
+  co_await pool.schedule();
+  for (int i = 0; i < count; ++i) {
+    co_await ch.async_send(i);
+  }
+  ch.close();
+}
+
+void coroutine_to_thread() {
+  thread_pool pool(1);
+  channel<int> ch(2, &pool);
+  spawn(produce(pool, ch, 5));
+  printf("received from a coroutine:");
+  while (std::optional<int> v = ch.recv()) {
+    printf(" %d", *v);
+  }
+  printf("\n");
+}
+
+// ===================================================================
+// BENCHMARK 1: ping-pong latency
+// ===================================================================
+// One message goes back and forth between two parties, through two
+// channels: every message wakes the other side.
+void ping_pong_threads(std::size_t rounds, std::size_t capacity) {
+  channel<std::size_t> ping(capacity);
+  channel<std::size_t> pong(capacity);
+  auto startTime = high_resolution_clock::now();
+  std::thread other([&] {
+    while (std::optional<std::size_t> v = ping.recv()) {
+      pong.send(*v + 1);
+    }
+  });
+  bool correct = true;
+  for (std::size_t i = 0; i < rounds; ++i) {
+    ping.send(i);
+    correct &= pong.recv() == i + 1;
+  }
+  ping.close();
+  other.join();
+  auto endTime = high_resolution_clock::now();
+  std::string tag = "threads,    capacity " + std::to_string(capacity);
+  tag.resize(36, ' ');
+  print_results(tag.c_str(), 2 * rounds, correct, startTime, endTime);
+}
+
+task<void> ponger(channel<std::size_t> &ping, channel<std::size_t> &pong,
+                  async_latch &done) {
+  while (std::optional<std::size_t> v = co_await ping.async_recv()) {
+    co_await pong.async_send(*v + 1);
+  }
+  done.count_down();
+}
+
+task<bool> pinger(channel<std::size_t> &ping, channel<std::size_t> &pong,
+                  std::size_t rounds, async_latch &done) {
+  bool correct = true;
+  for (std::size_t i = 0; i < rounds; ++i) {
+    co_await ping.async_send(i);
+    correct &= co_await pong.async_recv() == i + 1;
+  }
+  ping.close();
+  co_await done;
+  co_return correct;
+}
+
+void ping_pong_coroutines(std::size_t rounds, std::size_t capacity,
+                          unsigned threads) {
+  thread_pool pool(threads);
+  channel<std::size_t> ping(capacity, &pool);
+  channel<std::size_t> pong(capacity, &pool);
+  async_latch done(pool, 1);
+  auto startTime = high_resolution_clock::now();
+  spawn(ponger(ping, pong, done));
+  bool const correct = sync_wait(pinger(ping, pong, rounds, done));
+  auto endTime = high_resolution_clock::now();
+  std::string tag = "coroutines, capacity " + std::to_string(capacity) +
+                    ", " + std::to_string(threads) + " thread(s)";
+  tag.resize(36, ' ');
+  print_results(tag.c_str(), 2 * rounds, correct, startTime, endTime);
+}
+
+// ===================================================================
+// BENCHMARK 2: throughput
+// ===================================================================
+// One producer streams values to one consumer.
+void stream_threads(std::size_t count, std::size_t capacity) {
+  channel<std::size_t> ch(capacity);
+  auto startTime = high_resolution_clock::now();
+  std::thread producer([&] {
+    for (std::size_t i = 0; i < count; ++i) {
+      ch.send(i);
+    }
+    ch.close();
+  });
+  std::size_t sum = 0;
+  while (std::optional<std::size_t> v = ch.recv()) {
+    sum += *v;
+  }
+  producer.join();
+  auto endTime = high_resolution_clock::now();
+  std::string tag = "threads,    capacity " + std::to_string(capacity);
+  tag.resize(36, ' ');
+  print_results(tag.c_str(), count, sum == count * (count - 1) / 2,
+                startTime, endTime);
+}
+
+task<void> stream_producer(channel<std::size_t> &ch, std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    co_await ch.async_send(i);
+  }
+  ch.close();
+}
+
+task<std::size_t> stream_consumer(channel<std::size_t> &ch) {
+  std::size_t sum = 0;
+  while (std::optional<std::size_t> v = co_await ch.async_recv()) {
+    sum += *v;
+  }
+  co_return sum;
+}
+
+void stream_coroutines(std::size_t count, std::size_t capacity) {
+  thread_pool pool(2);
+  channel<std::size_t> ch(capacity, &pool);
+  auto startTime = high_resolution_clock::now();
+  spawn(stream_producer(ch, count));
+  std::size_t const sum = sync_wait(stream_consumer(ch));
+  auto endTime = high_resolution_clock::now();
+  std::string tag = "coroutines, capacity " + std::to_string(capacity);
+  tag.resize(36, ' ');
+  print_results(tag.c_str(), count, sum == count * (count - 1) / 2,
+                startTime, endTime);
+}
+
+int main(int argc, char **argv) {
+  const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+
+  workers();
+  selecting();
+  coroutine_to_thread();
+
+  std::size_t const rounds = count / 10;
+  printf("\nPing-pong, %zu round trips...\n", rounds);
+  ping_pong_threads(rounds, 0);
+  ping_pong_threads(rounds, 1);
+  ping_pong_coroutines(rounds, 0, 1);
+  ping_pong_coroutines(rounds, 0, 2);
+
+  printf("\nStreaming %zu values...\n", count);
+  for (std::size_t capacity : {0, 1, 64, 1024}) {
+    stream_threads(count, capacity);
+  }
+  for (std::size_t capacity : {0, 1, 64, 1024}) {
+    stream_coroutines(count, capacity);
+  }
+  return 0;
+}
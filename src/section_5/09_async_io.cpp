@@ -0,0 +1,206 @@
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_io.h"
+#include "async_sync.h"
+#include "section_8/thread_pool.h"
+#include "task.h"
+
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+constexpr std::size_t block_size = 4096;
+
+// Prints benchmark results, as MB/s and reads per second.
+void print_results(const char *const tag, std::size_t reads, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  double const seconds = duration<double>(endTime - startTime).count();
+  printf("%s: %8.0f MB/s %10.0f reads/s %s\n", tag,
+         reads * block_size / seconds / 1e6, reads / seconds,
+         correct ? "" : "WRONG RESULT");
+}
+
+// 4 KiB aligned, as O_DIRECT wants.
+struct aligned_block {
+  std::unique_ptr<std::byte, decltype(&std::free)> data{
+      static_cast<std::byte *>(std::aligned_alloc(block_size, block_size)),
+      &std::free};
+
+  std::byte *get() const { return data.get(); }
+  // every block starts with its index.
+  std::uint64_t index() const {
+    std::uint64_t i;
+    std::memcpy(&i, data.get(), sizeof(i));
+    return i;
+  }
+};
+
+void create_file(const char *path, std::size_t blocks) {
+  int const fd = ::open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+  aligned_block block;
+  std::memset(block.get(), 0xab, block_size);
+  for (std::uint64_t i = 0; i < blocks; ++i) {
+    std::memcpy(block.get(), &i, sizeof(i));
+    if (::pwrite(fd, block.get(), block_size, i * block_size) < 0) {
+      std::perror("pwrite");
+      std::exit(1);
+    }
+  }
+  ::fsync(fd);
+  ::close(fd);
+}
+
+// ===================================================================
+// Blocking pread from N threads
+// ===================================================================
+// Each thread reads a contiguous share of the block order.
+std::uint64_t read_threads(int fd, std::vector<std::uint64_t> const &order,
+                           unsigned threads) {
+  std::vector<std::uint64_t> sums(threads);
+  std::vector<std::thread> workers;
+  std::size_t const share = (order.size() + threads - 1) / threads;
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      aligned_block block;
+      std::size_t const end = std::min(order.size(), (t + 1) * share);
+      for (std::size_t i = t * share; i < end; ++i) {
+        if (::pread(fd, block.get(), block_size, order[i] * block_size) ==
+            static_cast<ssize_t>(block_size)) {
+          sums[t] += block.index();
+        }
+      }
+    });
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+  return std::accumulate(sums.begin(), sums.end(), std::uint64_t{0});
+}
+
+// ===================================================================
+// Coroutines on io_executor
+// ===================================================================
+// depth coroutines, each with one read in flight: coroutine c reads
+// blocks c, c + depth, c + 2 * depth... of the order.
+task<void> reader(io_executor &io, int fd,
+                  std::vector<std::uint64_t> const &order, std::size_t first,
+                  std::size_t step, std::uint64_t &sum, async_latch &done) {
+  aligned_block block;
+  for (std::size_t i = first; i < order.size(); i += step) {
+    ssize_t const n = co_await io.read(fd, block.get(), block_size,
+                                       order[i] * block_size);
+    if (n == static_cast<ssize_t>(block_size)) {
+      sum += block.index();
+    }
+  }
+  done.count_down();
+}
+
+task<void> wait_for(async_latch &latch) { co_await latch; }
+
+std::uint64_t read_coroutines(thread_pool &pool, io_executor &io, int fd,
+                              std::vector<std::uint64_t> const &order,
+                              std::size_t depth) {
+  std::vector<std::uint64_t> sums(depth);
+  async_latch done(pool, static_cast<std::ptrdiff_t>(depth));
+  for (std::size_t c = 0; c < depth; ++c) {
+    spawn(reader(io, fd, order, c, depth, sums[c], done));
+  }
+  sync_wait(wait_for(done));
+  return std::accumulate(sums.begin(), sums.end(), std::uint64_t{0});
+}
+
+// ===================================================================
+// Example: write, then read back
+// ===================================================================
+task<void> round_trip(io_executor &io, const char *path) {
+  int const fd = ::open(path, O_CREAT | O_TRUNC | O_RDWR, 0644);
+  char const message[] = "written and read back with co_await";
+  ssize_t const written = co_await io.write(fd, message, sizeof(message), 0);
+  char buffer[sizeof(message)] = {};
+  ssize_t const read = co_await io.read(fd, buffer, sizeof(buffer), 0);
+  printf("%zd bytes written, %zd read: %s\n", written, read, buffer);
+  ::close(fd);
+  ::unlink(path);
+}
+
+void run(const char *path, bool direct, std::vector<std::uint64_t> const &order,
+         const char *name) {
+  int const fd = ::open(path, O_RDONLY | (direct ? O_DIRECT : 0));
+  std::uint64_t const expected =
+      order.size() * (order.size() - 1) / 2; // sum of the indices
+  printf("\n%s 4 KiB reads%s...\n", name,
+         direct ? " (O_DIRECT)" : " (page cache)");
+
+  for (unsigned threads : {1, 4, 16}) {
+    auto startTime = high_resolution_clock::now();
+    std::uint64_t const sum = read_threads(fd, order, threads);
+    auto endTime = high_resolution_clock::now();
+    std::string tag = "pread, " + std::to_string(threads) + " thread(s)";
+    tag.resize(34, ' ');
+    print_results(tag.c_str(), order.size(), sum == expected, startTime,
+                  endTime);
+  }
+
+  thread_pool pool(1);
+  for (bool const use_io_uring : {true, false}) {
+    io_executor io(pool, 256, use_io_uring, 16);
+    if (use_io_uring && !io.uses_io_uring()) {
+      printf("io_uring not available\n");
+      continue;
+    }
+    for (std::size_t depth : {1, 16, 64}) {
+      auto startTime = high_resolution_clock::now();
+      std::uint64_t const sum = read_coroutines(pool, io, fd, order, depth);
+      auto endTime = high_resolution_clock::now();
+      std::string tag = std::string(use_io_uring ? "io_uring" : "fallback") +
+                        ", 1 thread, depth " + std::to_string(depth);
+      tag.resize(34, ' ');
+      print_results(tag.c_str(), order.size(), sum == expected, startTime,
+                    endTime);
+    }
+  }
+  ::close(fd);
+}
+
+int main(int argc, char **argv) {
+  const std::size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 256;
+  const std::string path = argc > 2 ? argv[2] : "/tmp/09_async_io.dat";
+  const bool direct = argc > 3 && std::string(argv[3]) == "direct";
+
+  {
+    thread_pool pool(1);
+    io_executor io(pool);
+    printf("io_uring: %s\n", io.uses_io_uring() ? "yes" : "no, fallback");
+    sync_wait(round_trip(io, (path + ".example").c_str()));
+  }
+
+  std::size_t const blocks = megabytes * 1024 * 1024 / block_size;
+  printf("\nCreating a %zu MB file (%zu blocks)...\n", megabytes, blocks);
+  create_file(path.c_str(), blocks);
+
+  std::vector<std::uint64_t> order(blocks);
+  std::iota(order.begin(), order.end(), std::uint64_t{0});
+  run(path.c_str(), direct, order, "Sequential");
+  std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+  run(path.c_str(), direct, order, "Random");
+
+  ::unlink(path.c_str());
+  return 0;
+}
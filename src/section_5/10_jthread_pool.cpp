@@ -0,0 +1,203 @@
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "jthread_pool.h"
+
+using namespace std::literals;
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+// ===================================================================
+// polling_pool: the pattern of interruptible_counter (01_jthread.cpp)
+// ===================================================================
+// An idle worker checks its stop_token and the queue, then sleeps for an
+// interval: both a stop request and a new task wait for the end of the
+// sleep.
+class polling_pool {
+  std::mutex mutex;
+  std::deque<std::function<void()>> queue;
+  std::chrono::microseconds const interval;
+  std::vector<std::jthread> workers;
+
+  void worker_thread(std::stop_token token) {
+    while (!token.stop_requested()) {
+      std::function<void()> task;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!queue.empty()) {
+          task = std::move(queue.front());
+          queue.pop_front();
+        }
+      }
+      if (task) {
+        task();
+      } else {
+        std::this_thread::sleep_for(interval);
+      }
+    }
+  }
+
+public:
+  polling_pool(unsigned thread_count, std::chrono::microseconds _interval)
+      : interval(_interval) {
+    for (unsigned i = 0; i < thread_count; ++i) {
+      workers.emplace_back(
+          [this](std::stop_token token) { worker_thread(std::move(token)); });
+    }
+  }
+
+  ~polling_pool() { request_stop(); }
+
+  void request_stop() {
+    for (auto &w : workers) {
+      w.request_stop();
+    }
+  }
+
+  template <typename F> void post(F &&f) {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.emplace_back(std::forward<F>(f));
+  }
+};
+
+// ===================================================================
+// Measurements
+// ===================================================================
+double process_cpu_seconds() {
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct results {
+  double shutdown_us = 0;  // request_stop() to all joined, worst run
+  double wakeup_us = 0;    // post() to the task running, average
+  double idle_cpu_ms = 0;  // CPU time burnt per second of idle pool
+};
+
+// make() creates a pool of threads workers on the heap.
+template <typename Make>
+results measure(Make make, unsigned threads, std::size_t runs) {
+  results r;
+
+  // idle CPU: the process only runs the idle pool for a second.
+  {
+    auto pool = make(threads);
+    std::this_thread::sleep_for(50ms); // workers started and idle
+    double const cpu = process_cpu_seconds();
+    std::this_thread::sleep_for(1s);
+    r.idle_cpu_ms = (process_cpu_seconds() - cpu) * 1e3;
+  }
+
+  // wakeup latency: tasks posted one at a time to an idle pool.
+  {
+    // the worker may still be in notify_one() when wait() returns: the flag
+    // must outlive the pool.
+    std::atomic<bool> done{false};
+    high_resolution_clock::time_point started;
+    auto pool = make(threads);
+    for (std::size_t i = 0; i < runs; ++i) {
+      std::this_thread::sleep_for(5ms);
+      done.store(false, std::memory_order_relaxed);
+      auto const posted = high_resolution_clock::now();
+      pool->post([&] {
+        started = high_resolution_clock::now();
+        done.store(true, std::memory_order_release);
+        done.notify_one();
+      });
+      done.wait(false, std::memory_order_acquire);
+      r.wakeup_us +=
+          duration<double, std::micro>(started - posted).count() / runs;
+    }
+  }
+
+  // shutdown latency, of an idle pool.
+  for (std::size_t i = 0; i < runs; ++i) {
+    auto pool = make(threads);
+    std::this_thread::sleep_for(5ms);
+    auto const startTime = high_resolution_clock::now();
+    pool->request_stop();
+    pool.reset(); // joins
+    auto const endTime = high_resolution_clock::now();
+    double const us = duration<double, std::micro>(endTime - startTime).count();
+    r.shutdown_us = std::max(r.shutdown_us, us);
+  }
+  return r;
+}
+
+void print_results(const char *const tag, results const &r) {
+  printf("%s: shutdown %10.1f us, wakeup %10.1f us, idle CPU %6.2f ms/s\n",
+         tag, r.shutdown_us, r.wakeup_us, r.idle_cpu_ms);
+}
+
+// ===================================================================
+// Example: a task that sleeps, interruptibly
+// ===================================================================
+// The stop_token of the worker ends the sleep as soon as the pool stops.
+void interruptible_task() {
+  std::future<int> dropped;
+  auto const startTime = high_resolution_clock::now();
+  {
+    std::atomic<bool> started{false}; // outlives the pool
+    jthread_pool pool(2);
+    pool.post([&started](std::stop_token token) {
+      std::mutex mutex;
+      std::condition_variable_any cv;
+      std::unique_lock<std::mutex> lock(mutex);
+      started.store(true);
+      started.notify_one();
+      cv.wait_for(lock, token, 10s, [] { return false; });
+    });
+    started.wait(false);
+    pool.request_stop();
+    dropped = pool.submit([] { return 42; });
+  } // joins
+  auto const endTime = high_resolution_clock::now();
+  printf("a 10s sleep in a task, stopped after %.1f ms\n",
+         duration<double, std::milli>(endTime - startTime).count());
+  try {
+    dropped.get();
+  } catch (std::future_error const &e) {
+    printf("task queued after the stop: %s\n", e.what());
+  }
+}
+
+int main(int argc, char **argv) {
+  const unsigned threads = argc > 1 ? std::stoul(argv[1]) : 8;
+  constexpr std::size_t runs = 20;
+
+  interruptible_task();
+
+  printf("\nPools of %u idle workers, %zu runs...\n", threads, runs);
+  for (auto interval : {1ms, 10ms, 200ms}) {
+    std::string tag = "polling, sleep " + std::to_string(interval.count()) +
+                      " ms";
+    tag.resize(29, ' ');
+    print_results(tag.c_str(),
+                  measure(
+                      [interval](unsigned n) {
+                        return std::make_unique<polling_pool>(n, interval);
+                      },
+                      threads, runs));
+  }
+  print_results(
+      "jthread_pool, cv + stop_token",
+      measure([](unsigned n) { return std::make_unique<jthread_pool>(n); },
+              threads, runs));
+  return 0;
+}
@@ -0,0 +1,403 @@
+#ifndef ASYNC_GENERATOR_H_
+#define ASYNC_GENERATOR_H_
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "frame_allocator.h"
+#include "section_8/thread_pool.h"
+#include "task.h"
+
+// ===================================================================
+// async_generator<T>
+// ===================================================================
+// A generator whose body can co_await (a task, pool.schedule(), ...)
+// between two co_yield. It is consumed from another coroutine:
+//   while (std::optional<T> v = co_await gen.next()) { ... }
+// next() resumes the generator by symmetric transfer, and the generator
+// transfers back to the consumer when it yields or returns, on whatever
+// thread it is running then. next() returns std::nullopt once the
+// generator has returned, and rethrows its exception.
+template <typename T, typename FrameAllocator = default_frame_allocator>
+class [[nodiscard]] async_generator {
+public:
+  struct promise_type;
+  using co_handle = std::coroutine_handle<promise_type>;
+
+  struct promise_type : FrameAllocator {
+    std::optional<T> value;
+    std::exception_ptr exception;
+    std::coroutine_handle<> consumer = std::noop_coroutine();
+
+    // on co_yield and on completion: back to the consumer.
+    struct to_consumer {
+      bool await_ready() const noexcept { return false; }
+      std::coroutine_handle<>
+      await_suspend(co_handle handle) const noexcept {
+        return handle.promise().consumer;
+      }
+      void await_resume() const noexcept {}
+    };
+
+    async_generator get_return_object() noexcept {
+      return async_generator(co_handle::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    to_consumer final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() noexcept {
+      exception = std::current_exception();
+    }
+
+    template <typename U>
+      requires std::is_convertible_v<U &&, T>
+    to_consumer yield_value(U &&u) {
+      value.emplace(std::forward<U>(u));
+      return {};
+    }
+  };
+
+  explicit async_generator(co_handle _handle) : handle(_handle) {}
+  async_generator(async_generator &&other) noexcept
+      : handle(std::exchange(other.handle, {})) {}
+  async_generator &operator=(async_generator &&other) noexcept {
+    if (this != &other) {
+      if (handle) {
+        handle.destroy();
+      }
+      handle = std::exchange(other.handle, {});
+    }
+    return *this;
+  }
+  ~async_generator() {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+
+  // non-copiable.
+  async_generator(async_generator const &) = delete;
+  async_generator &operator=(async_generator const &) = delete;
+
+  // Awaitable: the next value, or std::nullopt at the end.
+  auto next() {
+    struct awaiter {
+      co_handle handle;
+
+      bool await_ready() const noexcept { return handle.done(); }
+      std::coroutine_handle<>
+      await_suspend(std::coroutine_handle<> consumer) noexcept {
+        handle.promise().consumer = consumer;
+        return handle;
+      }
+      std::optional<T> await_resume() {
+        promise_type &promise = handle.promise();
+        if (promise.exception) {
+          std::rethrow_exception(std::exchange(promise.exception, {}));
+        }
+        if (handle.done()) {
+          return std::nullopt;
+        }
+        return std::exchange(promise.value, std::nullopt);
+      }
+    };
+    return awaiter{handle};
+  }
+
+private:
+  co_handle handle;
+};
+
+// ===================================================================
+// Pipelines
+// ===================================================================
+// Stages are chained with operator|:
+//   source() | pipeline::transform(f) | pipeline::via(pool, 64)
+//            | pipeline::filter(p) | pipeline::for_each(g)
+// - transform(f): f(value), or co_await f(value) when f returns a task.
+// - filter(p): keeps the values for which p(value) is true.
+// - via(pool, capacity): everything upstream runs as its own coroutine on
+//   the pool, and pushes into a bounded buffer that downstream pops from.
+//   Consecutive via() stages run concurrently, on different workers. When
+//   the buffer is full, the upstream coroutine is suspended until
+//   downstream pops (backpressure): no thread blocks, and at most
+//   capacity values wait between two stages.
+// - for_each(f): the sink, a task<void> that runs the whole pipeline.
+namespace pipeline {
+
+namespace detail {
+
+template <typename R> struct is_task : std::false_type {};
+template <typename U, typename A>
+struct is_task<task<U, A>> : std::true_type {
+  using value_type = U;
+};
+
+// Single producer, single consumer bounded buffer between two stages. A
+// side that has to wait is suspended and remembered, and the other side
+// resumes it on the pool. A waiting consumer gets the value directly, a
+// waiting producer leaves its value in its awaiter, and the consumer moves
+// it in when it makes room.
+template <typename T> class stage_buffer {
+  thread_pool &pool;
+  std::size_t const capacity;
+
+  std::mutex mutex;
+  std::deque<T> items;
+  bool closed = false;    // the producer is done
+  bool cancelled = false; // the consumer is gone
+  std::exception_ptr error;
+
+  struct push_awaiter;
+  struct pop_awaiter;
+  std::coroutine_handle<> waiting_producer;
+  push_awaiter *producer_awaiter = nullptr;
+  std::coroutine_handle<> waiting_consumer;
+  pop_awaiter *consumer_awaiter = nullptr;
+
+  void wake(std::coroutine_handle<> handle) {
+    if (handle) {
+      pool.post([handle] { handle.resume(); });
+    }
+  }
+
+  struct push_awaiter {
+    stage_buffer &buffer;
+    T value;
+    bool accepted = true;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> producer) {
+      std::coroutine_handle<> consumer;
+      {
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        if (buffer.cancelled) {
+          accepted = false;
+          return false;
+        }
+        if (buffer.waiting_consumer) {
+          buffer.consumer_awaiter->slot.emplace(std::move(value));
+          consumer = std::exchange(buffer.waiting_consumer, {});
+        } else if (buffer.items.size() < buffer.capacity) {
+          buffer.items.push_back(std::move(value));
+        } else {
+          buffer.waiting_producer = producer;
+          buffer.producer_awaiter = this;
+          return true;
+        }
+      }
+      buffer.wake(consumer);
+      return false;
+    }
+    // false if the consumer is gone: the producer should stop.
+    bool await_resume() const noexcept { return accepted; }
+  };
+
+  struct pop_awaiter {
+    stage_buffer &buffer;
+    std::optional<T> slot;
+
+    // A consumer frame destroyed while suspended here must not be resumed,
+    // nor receive a value, by a later push.
+    ~pop_awaiter() {
+      std::lock_guard<std::mutex> lock(buffer.mutex);
+      if (buffer.consumer_awaiter == this) {
+        buffer.consumer_awaiter = nullptr;
+        buffer.waiting_consumer = {};
+      }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> consumer) {
+      std::coroutine_handle<> producer;
+      {
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        if (!buffer.items.empty()) {
+          slot.emplace(std::move(buffer.items.front()));
+          buffer.items.pop_front();
+          if (buffer.waiting_producer) {
+            buffer.items.push_back(std::move(buffer.producer_awaiter->value));
+            producer = std::exchange(buffer.waiting_producer, {});
+          }
+        } else if (!buffer.closed) {
+          buffer.waiting_consumer = consumer;
+          buffer.consumer_awaiter = this;
+          return true;
+        }
+      }
+      buffer.wake(producer);
+      return false;
+    }
+    // std::nullopt once the producer is done and the buffer is empty.
+    std::optional<T> await_resume() {
+      if (!slot && buffer.error) {
+        std::rethrow_exception(buffer.error);
+      }
+      return std::move(slot);
+    }
+  };
+
+public:
+  stage_buffer(thread_pool &_pool, std::size_t _capacity)
+      : pool(_pool), capacity(_capacity > 0 ? _capacity : 1) {}
+
+  push_awaiter push(T value) { return {*this, std::move(value)}; }
+  pop_awaiter pop() { return {*this, std::nullopt}; }
+
+  // Producer side: no more values, or an exception.
+  void close(std::exception_ptr exception) {
+    std::coroutine_handle<> consumer;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      closed = true;
+      error = std::move(exception);
+      consumer = std::exchange(waiting_consumer, {});
+    }
+    wake(consumer);
+  }
+
+  // Consumer side: stops the producer at its next push.
+  void cancel() {
+    std::coroutine_handle<> producer;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      cancelled = true;
+      items.clear();
+      waiting_consumer = {};
+      if (waiting_producer) {
+        producer_awaiter->accepted = false;
+        producer = std::exchange(waiting_producer, {});
+      }
+    }
+    wake(producer);
+  }
+};
+
+// Runs upstream on the pool, into buffer.
+template <typename T, typename A>
+task<void, A> pump(async_generator<T, A> upstream,
+                   std::shared_ptr<stage_buffer<T>> buffer, thread_pool &pool) {
+  co_await pool.schedule();
+  std::exception_ptr error;
+  try {
+    while (std::optional<T> value = co_await upstream.next()) {
+      if (!co_await buffer->push(std::move(*value))) {
+        break;
+      }
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  buffer->close(std::move(error));
+}
+
+template <typename T> struct cancel_on_exit {
+  std::shared_ptr<stage_buffer<T>> buffer;
+  ~cancel_on_exit() { buffer->cancel(); }
+};
+
+template <typename T, typename A>
+async_generator<T, A> via(async_generator<T, A> upstream, thread_pool &pool,
+                          std::size_t capacity) {
+  auto buffer = std::make_shared<stage_buffer<T>>(pool, capacity);
+  cancel_on_exit<T> const guard{buffer};
+  spawn(pump(std::move(upstream), buffer, pool));
+  while (std::optional<T> value = co_await buffer->pop()) {
+    co_yield std::move(*value);
+  }
+}
+
+template <typename U, typename T, typename A, typename F>
+async_generator<U, A> transform(async_generator<T, A> upstream, F f) {
+  while (std::optional<T> value = co_await upstream.next()) {
+    if constexpr (is_task<std::invoke_result_t<F &, T>>::value) {
+      co_yield co_await f(std::move(*value));
+    } else {
+      co_yield f(std::move(*value));
+    }
+  }
+}
+
+template <typename T, typename A, typename F>
+async_generator<T, A> filter(async_generator<T, A> upstream, F f) {
+  while (std::optional<T> value = co_await upstream.next()) {
+    if (f(std::as_const(*value))) {
+      co_yield std::move(*value);
+    }
+  }
+}
+
+template <typename T, typename A, typename F>
+task<void, A> for_each(async_generator<T, A> upstream, F f) {
+  while (std::optional<T> value = co_await upstream.next()) {
+    f(std::move(*value));
+  }
+}
+
+} // namespace detail
+
+template <typename F> struct transform_stage {
+  F f;
+};
+template <typename F> struct filter_stage {
+  F f;
+};
+template <typename F> struct for_each_stage {
+  F f;
+};
+struct via_stage {
+  thread_pool &pool;
+  std::size_t capacity;
+};
+
+template <typename F> transform_stage<F> transform(F f) {
+  return {std::move(f)};
+}
+template <typename F> filter_stage<F> filter(F f) { return {std::move(f)}; }
+template <typename F> for_each_stage<F> for_each(F f) {
+  return {std::move(f)};
+}
+inline via_stage via(thread_pool &pool, std::size_t capacity) {
+  return {pool, capacity};
+}
+
+template <typename T, typename A, typename F>
+auto operator|(async_generator<T, A> upstream, transform_stage<F> stage) {
+  using R = std::invoke_result_t<F &, T>;
+  if constexpr (detail::is_task<R>::value) {
+    return detail::transform<typename detail::is_task<R>::value_type>(
+        std::move(upstream), std::move(stage.f));
+  } else {
+    return detail::transform<std::decay_t<R>>(std::move(upstream),
+                                              std::move(stage.f));
+  }
+}
+
+template <typename T, typename A, typename F>
+async_generator<T, A> operator|(async_generator<T, A> upstream,
+                                filter_stage<F> stage) {
+  return detail::filter(std::move(upstream), std::move(stage.f));
+}
+
+template <typename T, typename A>
+async_generator<T, A> operator|(async_generator<T, A> upstream,
+                                via_stage stage) {
+  return detail::via(std::move(upstream), stage.pool, stage.capacity);
+}
+
+template <typename T, typename A, typename F>
+task<void, A> operator|(async_generator<T, A> upstream,
+                        for_each_stage<F> stage) {
+  return detail::for_each(std::move(upstream), std::move(stage.f));
+}
+
+} // namespace pipeline
+
+#endif /* ASYNC_GENERATOR_H_ */
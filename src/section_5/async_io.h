@@ -0,0 +1,340 @@
+#ifndef ASYNC_IO_H_
+#define ASYNC_IO_H_
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "section_8/thread_pool.h"
+
+// ===================================================================
+// io_executor: asynchronous file reads and writes
+// ===================================================================
+//   ssize_t n = co_await io.read(fd, buffer, size, offset);
+// Like pread/pwrite, but the coroutine is suspended while the kernel does
+// the work, and resumed on the pool when it is done. The result is the
+// number of bytes, or -errno.
+// - io_uring (raw syscalls, no liburing): requests are written to the
+//   submission ring as they are issued, and submitted in batches. The
+//   first request of a batch posts a flush to the pool: the requests of
+//   every coroutine that runs before it go in the same io_uring_enter. A
+//   thread reaps the completion ring and posts the coroutines back.
+// - Fallback, when io_uring is not available (old kernel, seccomp,
+//   io_uring_disabled) or not wanted: every request is a blocking
+//   pread/pwrite on a pool of I/O threads.
+// Every request must have completed before the executor is destroyed.
+namespace async_io_detail {
+
+// A read or write, in the awaiter (in the coroutine frame).
+struct io_request {
+  std::uint8_t opcode;
+  int fd;
+  void *buffer;
+  unsigned size;
+  off_t offset;
+  ssize_t result = 0;
+  std::coroutine_handle<> handle;
+};
+
+inline ssize_t run_blocking(io_request const &r) {
+  ssize_t const n = r.opcode == IORING_OP_READ
+                        ? ::pread(r.fd, r.buffer, r.size, r.offset)
+                        : ::pwrite(r.fd, r.buffer, r.size, r.offset);
+  return n < 0 ? -errno : n;
+}
+
+template <typename T> T load_acquire(T *p) {
+  return std::atomic_ref<T>(*p).load(std::memory_order_acquire);
+}
+template <typename T> void store_release(T *p, T value) {
+  std::atomic_ref<T>(*p).store(value, std::memory_order_release);
+}
+
+// The rings shared with the kernel. One submitter at a time, one reaper.
+class uring {
+  int fd = -1;
+  void *sq_ring = MAP_FAILED;
+  std::size_t sq_ring_size = 0;
+  void *cq_ring = MAP_FAILED;
+  std::size_t cq_ring_size = 0;
+  io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+  std::size_t sqes_size = 0;
+
+  unsigned *sq_head, *sq_tail, *sq_array;
+  unsigned sq_mask, sq_entries;
+  unsigned *cq_head, *cq_tail;
+  unsigned cq_mask;
+  io_uring_cqe *cqes;
+
+  static void *map(std::size_t size, int _fd, off_t offset) {
+    return ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, _fd, offset);
+  }
+
+  template <typename T> T *at(void *ring, unsigned offset) {
+    return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+  }
+
+public:
+  uring() = default;
+  uring(uring const &) = delete;
+  uring &operator=(uring const &) = delete;
+
+  ~uring() {
+    if (sqes != MAP_FAILED) {
+      ::munmap(sqes, sqes_size);
+    }
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+      ::munmap(cq_ring, cq_ring_size);
+    }
+    if (sq_ring != MAP_FAILED) {
+      ::munmap(sq_ring, sq_ring_size);
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+
+  // false if io_uring is not available.
+  bool open(unsigned entries) {
+    io_uring_params params{};
+    fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+      return false;
+    }
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool const single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+    }
+    sq_ring = map(sq_ring_size, fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+      return false;
+    }
+    cq_ring = single_mmap ? sq_ring : map(cq_ring_size, fd, IORING_OFF_CQ_RING);
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe *>(map(sqes_size, fd, IORING_OFF_SQES));
+    if (cq_ring == MAP_FAILED || sqes == MAP_FAILED) {
+      return false;
+    }
+
+    sq_head = at<unsigned>(sq_ring, params.sq_off.head);
+    sq_tail = at<unsigned>(sq_ring, params.sq_off.tail);
+    sq_array = at<unsigned>(sq_ring, params.sq_off.array);
+    sq_mask = *at<unsigned>(sq_ring, params.sq_off.ring_mask);
+    sq_entries = params.sq_entries;
+    cq_head = at<unsigned>(cq_ring, params.cq_off.head);
+    cq_tail = at<unsigned>(cq_ring, params.cq_off.tail);
+    cq_mask = *at<unsigned>(cq_ring, params.cq_off.ring_mask);
+    cqes = at<io_uring_cqe>(cq_ring, params.cq_off.cqes);
+    return true;
+  }
+
+  // Writes a submission entry. false if the ring is full: submit first.
+  // user_data 0 is a no-op.
+  bool push(io_request *r) {
+    unsigned const tail = *sq_tail;
+    if (tail - load_acquire(sq_head) == sq_entries) {
+      return false;
+    }
+    unsigned const index = tail & sq_mask;
+    io_uring_sqe &sqe = sqes[index];
+    sqe = io_uring_sqe{};
+    if (r != nullptr) {
+      sqe.opcode = r->opcode;
+      sqe.fd = r->fd;
+      sqe.addr = reinterpret_cast<std::uintptr_t>(r->buffer);
+      sqe.len = r->size;
+      sqe.off = static_cast<std::uint64_t>(r->offset);
+    } else {
+      sqe.opcode = IORING_OP_NOP;
+    }
+    sqe.user_data = reinterpret_cast<std::uintptr_t>(r);
+    sq_array[index] = index;
+    store_release(sq_tail, tail + 1);
+    return true;
+  }
+
+  // Hands count entries to the kernel, which consumes them before
+  // returning.
+  void submit(unsigned count) {
+    while (count > 0) {
+      long const n = ::syscall(__NR_io_uring_enter, fd, count, 0, 0,
+                               nullptr, 0);
+      if (n < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+          std::this_thread::yield(); // completion ring full: reaper's turn
+          continue;
+        }
+        throw std::system_error(errno, std::system_category(),
+                                "io_uring_enter");
+      }
+      count -= static_cast<unsigned>(n);
+    }
+  }
+
+  // Waits for at least one completion, then calls f(user_data, result)
+  // for every completion available.
+  template <typename F> void reap(F f) {
+    unsigned head = *cq_head;
+    if (head == load_acquire(cq_tail)) {
+      ::syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS,
+                nullptr, 0);
+    }
+    unsigned const tail = load_acquire(cq_tail);
+    // the kernel orders completions after submissions; this makes it
+    // visible to the compiler (and sanitizers): requests are pushed, with
+    // their coroutine, before the release of sq_tail.
+    load_acquire(sq_tail);
+    for (; head != tail; ++head) {
+      io_uring_cqe const &cqe = cqes[head & cq_mask];
+      f(cqe.user_data, cqe.res);
+    }
+    store_release(cq_head, head);
+  }
+};
+
+} // namespace async_io_detail
+
+class io_executor {
+  using io_request = async_io_detail::io_request;
+
+  thread_pool &pool;
+  async_io_detail::uring ring;
+  bool const uring_enabled;
+
+  std::mutex submit_mutex;
+  unsigned pending = 0; // in the ring, not submitted yet
+  bool flush_posted = false;
+  std::thread reaper;
+
+  std::optional<thread_pool> blocking; // fallback
+
+  static void resume_on(thread_pool &pool, std::coroutine_handle<> handle) {
+    pool.post([handle] { handle.resume(); });
+  }
+
+  void flush() {
+    std::lock_guard<std::mutex> lock(submit_mutex);
+    ring.submit(std::exchange(pending, 0));
+    flush_posted = false;
+  }
+
+  // r == nullptr: a no-op, the reaper's signal to stop.
+  void submit(io_request *r) {
+    if (!uring_enabled) {
+      blocking->post([this, r] {
+        r->result = async_io_detail::run_blocking(*r);
+        resume_on(pool, r->handle);
+      });
+      return;
+    }
+    std::lock_guard<std::mutex> lock(submit_mutex);
+    if (!ring.push(r)) {
+      ring.submit(std::exchange(pending, 0));
+      ring.push(r);
+    }
+    ++pending;
+    if (r == nullptr) {
+      ring.submit(std::exchange(pending, 0));
+    } else if (!flush_posted) {
+      flush_posted = true;
+      pool.post([this] { flush(); });
+    }
+  }
+
+  void reap() {
+    for (bool stop = false; !stop;) {
+      ring.reap([this, &stop](std::uint64_t user_data, int result) {
+        if (user_data == 0) {
+          stop = true;
+          return;
+        }
+        auto *r = reinterpret_cast<io_request *>(user_data);
+        std::coroutine_handle<> const handle = r->handle;
+        r->result = result;
+        resume_on(pool, handle);
+      });
+    }
+  }
+
+  struct awaiter : io_request {
+    io_executor &executor;
+
+    awaiter(io_executor &_executor, io_request request)
+        : io_request(request), executor(_executor) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> _handle) {
+      handle = _handle;
+      executor.submit(this);
+    }
+    ssize_t await_resume() const noexcept { return result; }
+  };
+
+public:
+  // Coroutines are resumed on pool. entries: size of the submission ring.
+  // use_io_uring = false, or io_uring unavailable: blocking_threads I/O
+  // threads instead.
+  explicit io_executor(thread_pool &_pool, unsigned entries = 256,
+                       bool use_io_uring = true,
+                       unsigned blocking_threads = 16)
+      : pool(_pool), uring_enabled(use_io_uring && ring.open(entries)) {
+    if (uring_enabled) {
+      reaper = std::thread(&io_executor::reap, this);
+    } else {
+      blocking.emplace(blocking_threads);
+    }
+  }
+
+  ~io_executor() {
+    if (uring_enabled) {
+      submit(nullptr);
+      reaper.join();
+      // a flush may still be queued on the pool.
+      while (true) {
+        {
+          std::lock_guard<std::mutex> lock(submit_mutex);
+          if (!flush_posted) {
+            break;
+          }
+        }
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  io_executor(io_executor const &) = delete;
+  io_executor &operator=(io_executor const &) = delete;
+
+  bool uses_io_uring() const { return uring_enabled; }
+
+  // Awaitable: bytes read, or -errno.
+  awaiter read(int fd, void *buffer, unsigned size, off_t offset) {
+    return {*this, {IORING_OP_READ, fd, buffer, size, offset}};
+  }
+
+  // Awaitable: bytes written, or -errno.
+  awaiter write(int fd, void const *buffer, unsigned size, off_t offset) {
+    return {*this,
+            {IORING_OP_WRITE, fd, const_cast<void *>(buffer), size, offset}};
+  }
+};
+
+#endif /* ASYNC_IO_H_ */
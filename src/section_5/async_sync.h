@@ -0,0 +1,338 @@
+#ifndef ASYNC_SYNC_H_
+#define ASYNC_SYNC_H_
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+#include "section_8/thread_pool.h"
+
+// ===================================================================
+// Awaitable synchronization: async_mutex, async_semaphore, async_latch
+// ===================================================================
+// A coroutine that locks a std::mutex (or the spinlock of section_6)
+// blocks the worker thread running it, and every coroutine queued on that
+// thread with it. With these primitives, a coroutine that has to wait is
+// suspended instead, and the thread goes on with other work:
+// - The awaiter, which lives in the coroutine frame, is the node of an
+//   intrusive lock-free list of waiters. Waiters push themselves with a
+//   CAS; the list is taken whole with an exchange. No node is ever popped
+//   by CAS, so there is no ABA problem.
+// - Waiters are resumed on the pool by the coroutine that makes them
+//   ready (unlock, release, count_down). Resuming them inline would nest
+//   every handoff of a long queue on the same stack.
+// - A lock can be held across a co_await, and released on another thread.
+namespace async_sync_detail {
+
+struct waiter {
+  std::coroutine_handle<> handle;
+  waiter *next = nullptr;
+};
+
+// Never a valid awaiter address: marks an unlocked mutex, or a closed
+// list.
+inline waiter *sentinel() { return reinterpret_cast<waiter *>(1); }
+
+// Waiters are pushed in front: oldest first is the reverse order.
+inline waiter *reverse(waiter *list) {
+  waiter *reversed = nullptr;
+  while (list != nullptr) {
+    waiter *const next = list->next;
+    list->next = reversed;
+    reversed = list;
+    list = next;
+  }
+  return reversed;
+}
+
+inline void resume_on(thread_pool &pool, std::coroutine_handle<> handle) {
+  pool.post([handle] { handle.resume(); });
+}
+
+// Pushes w, unless the list is closed: then returns false.
+inline bool push_unless_closed(std::atomic<waiter *> &list, waiter *w) {
+  waiter *head = list.load(std::memory_order_relaxed);
+  do {
+    if (head == sentinel()) {
+      return false;
+    }
+    w->next = head;
+  } while (!list.compare_exchange_weak(head, w, std::memory_order_release,
+                                       std::memory_order_acquire));
+  return true;
+}
+
+} // namespace async_sync_detail
+
+// ===================================================================
+// async_mutex
+// ===================================================================
+//   co_await mutex.lock(); ... mutex.unlock();
+//   { auto guard = co_await mutex.scoped_lock(); ... }
+// The state is one pointer: unlocked (sentinel), locked without waiters
+// (nullptr), or locked with the list of the waiters that arrived since
+// the last unlock, newest first. unlock() takes that list, in FIFO order,
+// into a queue that only the holder touches, and hands the mutex to the
+// oldest waiter without unlocking it: waiters get the lock in order.
+class async_mutex {
+  using waiter = async_sync_detail::waiter;
+
+  thread_pool &pool;
+  std::atomic<waiter *> state{async_sync_detail::sentinel()};
+  waiter *queue = nullptr; // oldest first, holder only
+
+  struct lock_awaiter : waiter {
+    async_mutex &mutex;
+
+    explicit lock_awaiter(async_mutex &_mutex) : mutex(_mutex) {}
+
+    bool await_ready() noexcept { return mutex.try_lock(); }
+    bool await_suspend(std::coroutine_handle<> _handle) noexcept {
+      handle = _handle;
+      waiter *old = mutex.state.load(std::memory_order_relaxed);
+      while (true) {
+        if (old == async_sync_detail::sentinel()) {
+          if (mutex.state.compare_exchange_weak(old, nullptr,
+                                                std::memory_order_acquire,
+                                                std::memory_order_relaxed)) {
+            return false; // unlocked meanwhile: got it
+          }
+        } else {
+          next = old;
+          if (mutex.state.compare_exchange_weak(old, this,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+            return true;
+          }
+        }
+      }
+    }
+    void await_resume() const noexcept {}
+  };
+
+public:
+  // Unlocks on destruction.
+  class lock_guard {
+    async_mutex *mutex;
+
+  public:
+    explicit lock_guard(async_mutex &_mutex) : mutex(&_mutex) {}
+    lock_guard(lock_guard &&other) noexcept
+        : mutex(std::exchange(other.mutex, nullptr)) {}
+    lock_guard &operator=(lock_guard &&) = delete;
+    ~lock_guard() {
+      if (mutex != nullptr) {
+        mutex->unlock();
+      }
+    }
+  };
+
+  explicit async_mutex(thread_pool &_pool) : pool(_pool) {}
+
+  async_mutex(async_mutex const &) = delete;
+  async_mutex &operator=(async_mutex const &) = delete;
+
+  bool try_lock() noexcept {
+    waiter *old = async_sync_detail::sentinel();
+    return state.compare_exchange_strong(old, nullptr,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed);
+  }
+
+  // Awaitable: suspends until the mutex is ours.
+  lock_awaiter lock() noexcept { return lock_awaiter(*this); }
+
+  // Awaitable: as lock(), returns a lock_guard.
+  auto scoped_lock() noexcept {
+    struct awaiter : lock_awaiter {
+      using lock_awaiter::lock_awaiter;
+      lock_guard await_resume() const noexcept {
+        return lock_guard(this->mutex);
+      }
+    };
+    return awaiter(*this);
+  }
+
+  void unlock() {
+    if (queue == nullptr) {
+      waiter *old = nullptr;
+      if (state.compare_exchange_strong(old, async_sync_detail::sentinel(),
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+        return;
+      }
+      queue = async_sync_detail::reverse(
+          state.exchange(nullptr, std::memory_order_acquire));
+    }
+    waiter *const next = queue;
+    queue = next->next;
+    async_sync_detail::resume_on(pool, next->handle);
+  }
+};
+
+// ===================================================================
+// async_semaphore
+// ===================================================================
+//   co_await semaphore.acquire(); ... semaphore.release();
+// count is the number of free permits, or minus the number of waiters. A
+// coroutine that takes count to zero or below pushes itself to the list
+// of waiters; release() from below zero owes wakeups. One thread at a
+// time (the dispatcher) takes the list and hands the owed wakeups out,
+// oldest waiter first. A waiter can be owed a wakeup just before it is
+// pushed: the dispatcher then yields until it shows up.
+class async_semaphore {
+  using waiter = async_sync_detail::waiter;
+
+  thread_pool &pool;
+  std::atomic<std::ptrdiff_t> count;
+  std::atomic<waiter *> incoming{nullptr};
+  std::atomic<std::size_t> owed{0};
+  std::atomic<bool> dispatching{false};
+  waiter *queue = nullptr; // oldest first, dispatcher only
+
+  struct acquire_awaiter : waiter {
+    async_semaphore &semaphore;
+
+    explicit acquire_awaiter(async_semaphore &_semaphore)
+        : semaphore(_semaphore) {}
+
+    bool await_ready() noexcept { return semaphore.try_acquire(); }
+    bool await_suspend(std::coroutine_handle<> _handle) noexcept {
+      handle = _handle;
+      if (semaphore.count.fetch_sub(1, std::memory_order_acquire) > 0) {
+        return false;
+      }
+      waiter *head = semaphore.incoming.load(std::memory_order_relaxed);
+      do {
+        next = head;
+      } while (!semaphore.incoming.compare_exchange_weak(
+          head, this, std::memory_order_release, std::memory_order_relaxed));
+      return true;
+    }
+    void await_resume() const noexcept {}
+  };
+
+  // Only the dispatcher gets past the exchange. owed and dispatching are
+  // sequentially consistent: a release that fails to become dispatcher is
+  // seen by the current one, before or after it steps down.
+  void dispatch() {
+    do {
+      if (dispatching.exchange(true)) {
+        return;
+      }
+      while (owed.load() > 0) {
+        if (queue == nullptr) {
+          waiter *taken;
+          while ((taken = incoming.exchange(
+                      nullptr, std::memory_order_acquire)) == nullptr) {
+            std::this_thread::yield(); // owed, not pushed yet
+          }
+          queue = async_sync_detail::reverse(taken);
+        }
+        waiter *const next = queue;
+        queue = next->next;
+        owed.fetch_sub(1);
+        async_sync_detail::resume_on(pool, next->handle);
+      }
+      dispatching.store(false);
+    } while (owed.load() > 0);
+  }
+
+public:
+  async_semaphore(thread_pool &_pool, std::ptrdiff_t permits)
+      : pool(_pool), count(permits) {}
+
+  async_semaphore(async_semaphore const &) = delete;
+  async_semaphore &operator=(async_semaphore const &) = delete;
+
+  bool try_acquire() noexcept {
+    std::ptrdiff_t old = count.load(std::memory_order_relaxed);
+    while (old > 0) {
+      if (count.compare_exchange_weak(old, old - 1,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Awaitable: suspends until a permit is ours.
+  acquire_awaiter acquire() noexcept { return acquire_awaiter(*this); }
+
+  void release(std::ptrdiff_t permits = 1) {
+    std::ptrdiff_t const old =
+        count.fetch_add(permits, std::memory_order_release);
+    if (old >= 0) {
+      return;
+    }
+    owed.fetch_add(static_cast<std::size_t>(std::min(permits, -old)));
+    dispatch();
+  }
+};
+
+// ===================================================================
+// async_latch
+// ===================================================================
+//   latch.count_down();   // from count coroutines or threads
+//   co_await latch;       // resumes once the count has reached zero
+// The list of waiters is closed (sentinel) when the count reaches zero:
+// later waiters do not suspend.
+class async_latch {
+  using waiter = async_sync_detail::waiter;
+
+  thread_pool &pool;
+  std::atomic<std::ptrdiff_t> count;
+  std::atomic<waiter *> waiters;
+
+  struct awaiter : waiter {
+    async_latch &latch;
+
+    explicit awaiter(async_latch &_latch) : latch(_latch) {}
+
+    bool await_ready() const noexcept { return latch.try_wait(); }
+    bool await_suspend(std::coroutine_handle<> _handle) noexcept {
+      handle = _handle;
+      return async_sync_detail::push_unless_closed(latch.waiters, this);
+    }
+    void await_resume() const noexcept {}
+  };
+
+public:
+  async_latch(thread_pool &_pool, std::ptrdiff_t _count)
+      : pool(_pool), count(_count),
+        waiters(_count > 0 ? nullptr : async_sync_detail::sentinel()) {}
+
+  async_latch(async_latch const &) = delete;
+  async_latch &operator=(async_latch const &) = delete;
+
+  bool try_wait() const noexcept {
+    return waiters.load(std::memory_order_acquire) ==
+           async_sync_detail::sentinel();
+  }
+
+  // The waiters may destroy the latch once resumed: nothing is read from
+  // it after the first resume.
+  void count_down(std::ptrdiff_t n = 1) {
+    if (count.fetch_sub(n, std::memory_order_acq_rel) != n) {
+      return;
+    }
+    thread_pool &resume_pool = pool;
+    waiter *w = async_sync_detail::reverse(
+        waiters.exchange(async_sync_detail::sentinel(),
+                         std::memory_order_acq_rel));
+    while (w != nullptr) {
+      waiter *const next = w->next;
+      async_sync_detail::resume_on(resume_pool, w->handle);
+      w = next;
+    }
+  }
+
+  awaiter operator co_await() noexcept { return awaiter(*this); }
+};
+
+#endif /* ASYNC_SYNC_H_ */
@@ -0,0 +1,457 @@
+#ifndef CHANNEL_H_
+#define CHANNEL_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "section_8/thread_pool.h"
+
+// ===================================================================
+// channel<T>: bounded Go-style channel
+// ===================================================================
+// Values go through a buffer of capacity values (0: every send waits for
+// a receiver). The same channel can be used from threads and coroutines:
+//   ch.send(v); ch.recv();                       // block the thread
+//   co_await ch.async_send(v); co_await ch.async_recv(); // suspend
+//   ch.try_send(v); ch.try_recv();               // never wait
+// - send returns false once the channel is closed. recv returns the
+//   buffered values, then std::nullopt once it is closed.
+// - A sender that finds a receiver waiting moves the value straight into
+//   the receiver's result, and a receiver that makes room takes the value
+//   of the oldest waiting sender: a waiter is always woken with its
+//   operation already done.
+// - select(on_recv(a, f), on_send(b, v, g), ...) waits until one case
+//   completes, and calls its handler with the result (co_await
+//   async_select(...) in coroutines). The ready cases are tried in order.
+// - A waiting coroutine is resumed on the channel's pool, or inline by
+//   the thread that wakes it if the channel has none.
+template <typename T> class channel;
+
+namespace channel_detail {
+
+// One waiting send, recv or select. The first channel that completes one
+// of its cases claims it (fired), the other channels drop their waiters.
+struct operation {
+  std::atomic<int> fired{-1};
+  std::coroutine_handle<> handle; // nullptr: a thread
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool woken = false;
+
+  bool claim(int index) {
+    int expected = -1;
+    return fired.compare_exchange_strong(expected, index,
+                                         std::memory_order_acq_rel);
+  }
+
+  void wake(thread_pool *pool) {
+    if (handle) {
+      if (pool != nullptr) {
+        pool->post([handle = handle] { handle.resume(); });
+      } else {
+        handle.resume();
+      }
+      return;
+    }
+    // signalled under the mutex: the thread cannot return (and destroy
+    // this) before we are done.
+    std::lock_guard<std::mutex> lock(mutex);
+    woken = true;
+    cv.notify_one();
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return woken; });
+  }
+};
+
+struct wakeup {
+  operation *op = nullptr;
+  thread_pool *pool = nullptr;
+
+  void operator()() const {
+    if (op != nullptr) {
+      op->wake(pool);
+    }
+  }
+};
+
+// A case of an operation, queued on a channel.
+template <typename T> struct waiter {
+  operation *op = nullptr;
+  int index = 0;
+  T *send_value = nullptr;              // senders
+  std::optional<T> *recv_slot = nullptr; // receivers
+  bool sent = false;
+  bool linked = false;
+  waiter *prev = nullptr;
+  waiter *next = nullptr;
+};
+
+// Intrusive FIFO, under the channel mutex.
+template <typename T> class waiter_queue {
+  waiter<T> *head = nullptr;
+  waiter<T> *tail = nullptr;
+
+public:
+  void push_back(waiter<T> *w) {
+    w->prev = tail;
+    w->next = nullptr;
+    (tail != nullptr ? tail->next : head) = w;
+    tail = w;
+    w->linked = true;
+  }
+
+  void remove(waiter<T> *w) {
+    if (!w->linked) {
+      return;
+    }
+    (w->prev != nullptr ? w->prev->next : head) = w->next;
+    (w->next != nullptr ? w->next->prev : tail) = w->prev;
+    w->linked = false;
+  }
+
+  waiter<T> *pop_front() {
+    waiter<T> *const w = head;
+    if (w != nullptr) {
+      remove(w);
+    }
+    return w;
+  }
+};
+
+enum class status { done, closed, would_block };
+
+// The cases of select. Each one runs on its channel, under its mutex.
+template <typename T> struct recv_case {
+  channel<T> *ch;
+  std::optional<T> slot;
+  waiter<T> w;
+
+  std::mutex &mutex() { return ch->mutex; }
+  bool try_locked(wakeup &wake) {
+    return ch->recv_locked(slot, wake) != status::would_block;
+  }
+  void enqueue_locked(operation &op, int index) {
+    w.op = &op;
+    w.index = index;
+    w.recv_slot = &slot;
+    ch->receivers.push_back(&w);
+  }
+  void dequeue_locked() { ch->receivers.remove(&w); }
+  void complete() {}
+  // the value, or std::nullopt if closed.
+  std::optional<T> result() { return std::move(slot); }
+};
+
+template <typename T> struct send_case {
+  channel<T> *ch;
+  T value;
+  waiter<T> w;
+
+  std::mutex &mutex() { return ch->mutex; }
+  bool try_locked(wakeup &wake) {
+    status const s = ch->send_locked(value, wake);
+    w.sent = s == status::done;
+    return s != status::would_block;
+  }
+  void enqueue_locked(operation &op, int index) {
+    w.op = &op;
+    w.index = index;
+    w.send_value = &value;
+    ch->senders.push_back(&w);
+  }
+  void dequeue_locked() { ch->senders.remove(&w); }
+  void complete() {}
+  // false if closed.
+  bool result() const { return w.sent; }
+};
+
+// A case of select, and what to do with its result. Plain cases are
+// single sends and receives: their result is read after finish().
+template <typename Case, typename F> struct handled : Case {
+  F handler;
+
+  void complete() { handler(this->result()); }
+};
+
+// Runs one operation over a set of cases. start() locks every channel
+// involved, in address order, and either completes the first ready case
+// or queues a waiter on every channel. It touches nothing of the selector
+// once the locks are released: a coroutine can be resumed elsewhere as
+// soon as that happens. finish() drops the waiters that did not fire.
+template <typename... Cases> class selector {
+  static constexpr std::size_t size = sizeof...(Cases);
+
+  std::tuple<Cases...> cases;
+  operation op;
+
+  template <std::size_t... I>
+  bool start(std::coroutine_handle<> handle, std::index_sequence<I...>) {
+    op.handle = handle;
+    std::array<std::mutex *, size> mutexes{&std::get<I>(cases).mutex()...};
+    std::sort(mutexes.begin(), mutexes.end());
+    auto const last = std::unique(mutexes.begin(), mutexes.end());
+    for (auto it = mutexes.begin(); it != last; ++it) {
+      (*it)->lock();
+    }
+    wakeup wake;
+    int ready = -1;
+    ((ready < 0 && std::get<I>(cases).try_locked(wake)
+          ? ready = static_cast<int>(I)
+          : 0),
+     ...);
+    if (ready >= 0) {
+      op.fired.store(ready, std::memory_order_relaxed);
+    } else {
+      (std::get<I>(cases).enqueue_locked(op, static_cast<int>(I)), ...);
+    }
+    for (auto it = mutexes.begin(); it != last; ++it) {
+      (*it)->unlock();
+    }
+    wake();
+    return ready < 0;
+  }
+
+  template <std::size_t I> void drop() {
+    auto &c = std::get<I>(cases);
+    std::lock_guard<std::mutex> lock(c.mutex());
+    c.dequeue_locked();
+  }
+
+  template <std::size_t... I> std::size_t finish(std::index_sequence<I...>) {
+    int const index = op.fired.load(std::memory_order_acquire);
+    if constexpr (size > 1) {
+      ((static_cast<int>(I) != index ? drop<I>() : void()), ...);
+    }
+    ((static_cast<int>(I) == index ? std::get<I>(cases).complete() : void()),
+     ...);
+    return static_cast<std::size_t>(index);
+  }
+
+public:
+  explicit selector(Cases... _cases) : cases(std::move(_cases)...) {}
+
+  // false: done. true: the caller must wait for a channel to wake it.
+  bool start(std::coroutine_handle<> handle) {
+    return start(handle, std::index_sequence_for<Cases...>());
+  }
+  void wait() { op.wait(); }
+  // Index of the case that completed.
+  std::size_t finish() { return finish(std::index_sequence_for<Cases...>()); }
+
+  template <std::size_t I> auto &get() { return std::get<I>(cases); }
+};
+
+template <typename Result, typename... Cases> struct awaiter {
+  selector<Cases...> s;
+
+  explicit awaiter(Cases... cases) : s(std::move(cases)...) {}
+
+  bool await_ready() const noexcept { return false; }
+  bool await_suspend(std::coroutine_handle<> handle) {
+    return s.start(handle);
+  }
+  Result await_resume() {
+    std::size_t const index = s.finish();
+    if constexpr (std::is_same_v<Result, std::size_t>) {
+      return index;
+    } else {
+      return s.template get<0>().result();
+    }
+  }
+};
+
+} // namespace channel_detail
+
+template <typename T> class channel {
+  template <typename> friend struct channel_detail::recv_case;
+  template <typename> friend struct channel_detail::send_case;
+
+  using status = channel_detail::status;
+  using recv_op = channel_detail::recv_case<T>;
+  using send_op = channel_detail::send_case<T>;
+
+  std::mutex mutex;
+  std::deque<T> buffer;
+  std::size_t const capacity;
+  bool closed = false;
+  channel_detail::waiter_queue<T> receivers;
+  channel_detail::waiter_queue<T> senders;
+  thread_pool *const pool;
+
+  // Under the mutex. value is moved from only when done.
+  status send_locked(T &value, channel_detail::wakeup &wake) {
+    if (closed) {
+      return status::closed;
+    }
+    // waiters of a select that fired elsewhere are dropped.
+    while (channel_detail::waiter<T> *r = receivers.pop_front()) {
+      if (r->op->claim(r->index)) {
+        r->recv_slot->emplace(std::move(value));
+        wake = {r->op, pool};
+        return status::done;
+      }
+    }
+    if (buffer.size() < capacity) {
+      buffer.push_back(std::move(value));
+      return status::done;
+    }
+    return status::would_block;
+  }
+
+  // Under the mutex.
+  status recv_locked(std::optional<T> &slot, channel_detail::wakeup &wake) {
+    if (!buffer.empty()) {
+      slot.emplace(std::move(buffer.front()));
+      buffer.pop_front();
+    }
+    while (channel_detail::waiter<T> *s = senders.pop_front()) {
+      if (s->op->claim(s->index)) {
+        // into the room just made, or straight to us (capacity 0)
+        if (slot) {
+          buffer.push_back(std::move(*s->send_value));
+        } else {
+          slot.emplace(std::move(*s->send_value));
+        }
+        s->sent = true;
+        wake = {s->op, pool};
+        return status::done;
+      }
+    }
+    if (slot) {
+      return status::done;
+    }
+    return closed ? status::closed : status::would_block;
+  }
+
+  template <typename Op> static void run(channel_detail::selector<Op> &s) {
+    if (s.start({})) {
+      s.wait();
+    }
+    s.finish();
+  }
+
+public:
+  explicit channel(std::size_t _capacity, thread_pool *_pool = nullptr)
+      : capacity(_capacity), pool(_pool) {}
+
+  channel(channel const &) = delete;
+  channel &operator=(channel const &) = delete;
+
+  // Blocks until sent, false if the channel is closed.
+  bool send(T value) {
+    channel_detail::selector<send_op> s(send_op{this, std::move(value), {}});
+    run(s);
+    return s.template get<0>().result();
+  }
+
+  // Blocks until a value arrives, std::nullopt once closed and empty.
+  std::optional<T> recv() {
+    channel_detail::selector<recv_op> s(recv_op{this, std::nullopt, {}});
+    run(s);
+    return s.template get<0>().result();
+  }
+
+  // Sends without waiting. value is moved from only on success.
+  bool try_send(T &value) {
+    channel_detail::wakeup wake;
+    status s;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      s = send_locked(value, wake);
+    }
+    wake();
+    return s == status::done;
+  }
+
+  // A value if one is ready.
+  std::optional<T> try_recv() {
+    channel_detail::wakeup wake;
+    std::optional<T> slot;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      recv_locked(slot, wake);
+    }
+    wake();
+    return slot;
+  }
+
+  // Wakes every waiter: senders fail, receivers get the buffered values,
+  // then std::nullopt.
+  void close() {
+    std::vector<channel_detail::operation *> woken;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      closed = true;
+      while (channel_detail::waiter<T> *r = receivers.pop_front()) {
+        if (r->op->claim(r->index)) {
+          woken.push_back(r->op);
+        }
+      }
+      while (channel_detail::waiter<T> *s = senders.pop_front()) {
+        if (s->op->claim(s->index)) {
+          woken.push_back(s->op);
+        }
+      }
+    }
+    for (channel_detail::operation *op : woken) {
+      op->wake(pool);
+    }
+  }
+
+  // Awaitable: bool, as send().
+  auto async_send(T value) {
+    return channel_detail::awaiter<bool, send_op>(
+        send_op{this, std::move(value), {}});
+  }
+
+  // Awaitable: std::optional<T>, as recv().
+  auto async_recv() {
+    return channel_detail::awaiter<std::optional<T>, recv_op>(
+        recv_op{this, std::nullopt, {}});
+  }
+};
+
+// ===================================================================
+// select
+// ===================================================================
+// on_recv(ch, f): f(std::optional<T>) when a value (or the close) arrives.
+// on_send(ch, v, f): f(bool) when v is sent (or the channel closed).
+template <typename T, typename F> auto on_recv(channel<T> &ch, F f) {
+  return channel_detail::handled<channel_detail::recv_case<T>, F>{
+      {&ch, std::nullopt, {}}, std::move(f)};
+}
+
+template <typename T, typename F>
+auto on_send(channel<T> &ch, T value, F f) {
+  return channel_detail::handled<channel_detail::send_case<T>, F>{
+      {&ch, std::move(value), {}}, std::move(f)};
+}
+
+// Blocks until one case completes, returns its index.
+template <typename... Cases> std::size_t select(Cases... cases) {
+  channel_detail::selector<Cases...> s(std::move(cases)...);
+  if (s.start({})) {
+    s.wait();
+  }
+  return s.finish();
+}
+
+// Awaitable: the index of the case that completed.
+template <typename... Cases> auto async_select(Cases... cases) {
+  return channel_detail::awaiter<std::size_t, Cases...>(std::move(cases)...);
+}
+
+#endif /* CHANNEL_H_ */
@@ -0,0 +1,214 @@
+#ifndef FRAME_ALLOCATOR_H_
+#define FRAME_ALLOCATOR_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// ===================================================================
+// Coroutine frame allocators
+// ===================================================================
+// A promise type opts into a frame allocator by deriving from it: the
+// compiler allocates the frame with the promise operator new/delete. The
+// coroutine types of this section (Generator, task) take the allocator as
+// a template parameter instead, defaulting to default_frame_allocator.
+//
+// default_frame_allocator: the global heap.
+//
+// recycling_frame_allocator: freed frames are kept in thread-local free
+// lists, one per size class (multiples of 64 bytes, up to 1KB), and reused
+// by the next coroutine of that size on the same thread, without going to
+// malloc. Frames larger than the largest class use the global heap.
+// - Every frame starts with a header pointing to the cache of the thread
+//   that allocated it. A frame freed on another thread is pushed to a
+//   lock-free stack of that cache (remote frees), which the owner takes
+//   back, all at once, when its own free list is empty.
+// - When a thread exits, its cache closes the remote stack and releases
+//   the frames it holds. Frames still alive are released to the heap when
+//   they are freed; the last one deletes the cache.
+struct default_frame_allocator {
+  static void *allocate(std::size_t size) { return ::operator new(size); }
+  static void deallocate(void *frame, std::size_t size) {
+    ::operator delete(frame, size);
+  }
+
+  static void *operator new(std::size_t size) { return allocate(size); }
+  static void operator delete(void *frame, std::size_t size) {
+    deallocate(frame, size);
+  }
+};
+
+namespace frame_allocator_detail {
+
+constexpr std::size_t class_size = 64;
+constexpr std::size_t num_classes = 16; // up to 1KB
+constexpr std::size_t max_cached = 1024; // frames per class and thread
+constexpr std::uint32_t no_class = num_classes;
+
+struct thread_cache;
+
+// The open cache of the calling thread, if any. A plain pointer: reading it
+// never creates a cache, and it stays valid during thread exit, after the
+// cache is closed.
+inline thread_local thread_cache *current_cache = nullptr;
+
+// In front of every frame. Keeps the frame aligned to 16 bytes.
+struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) block_header {
+  thread_cache *owner;
+  std::uint32_t size_class;
+};
+
+// Free blocks are linked through their first bytes.
+struct free_block {
+  free_block *next;
+};
+
+struct thread_cache {
+  std::array<free_block *, num_classes> free_lists{};
+  std::array<std::size_t, num_classes> free_counts{};
+  // blocks pointing to this cache, plus one for the owner thread.
+  std::atomic<std::size_t> refs{1};
+  // frames freed by other threads. closed once the owner has exited.
+  std::atomic<free_block *> remote{nullptr};
+
+  static free_block *closed() {
+    return reinterpret_cast<free_block *>(std::uintptr_t(1));
+  }
+
+  void release_ref() {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  // Frees a block of this cache to the heap.
+  void release(free_block *block) {
+    ::operator delete(static_cast<void *>(block));
+    release_ref();
+  }
+
+  // Owner thread: moves the remote frees to the free lists.
+  void take_remote() {
+    free_block *block = remote.exchange(nullptr, std::memory_order_acquire);
+    while (block != nullptr) {
+      free_block *const next = block->next;
+      auto *header = reinterpret_cast<block_header *>(block);
+      push_local(block, header->size_class);
+      block = next;
+    }
+  }
+
+  void push_local(free_block *block, std::uint32_t size_class) {
+    if (free_counts[size_class] >= max_cached) {
+      release(block);
+      return;
+    }
+    block->next = free_lists[size_class];
+    free_lists[size_class] = block;
+    ++free_counts[size_class];
+  }
+
+  // Any thread but the owner.
+  void push_remote(free_block *block) {
+    free_block *head = remote.load(std::memory_order_relaxed);
+    do {
+      if (head == closed()) {
+        release(block); // the owner has exited
+        return;
+      }
+      block->next = head;
+    } while (!remote.compare_exchange_weak(head, block,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+  }
+
+  // Owner thread exit.
+  void close() {
+    current_cache = nullptr; // later frees of this thread go remote
+    free_block *block = remote.exchange(closed(), std::memory_order_acquire);
+    while (block != nullptr) {
+      free_block *const next = block->next;
+      release(block);
+      block = next;
+    }
+    for (std::size_t c = 0; c < num_classes; ++c) {
+      while (free_lists[c] != nullptr) {
+        free_block *const next = free_lists[c]->next;
+        release(free_lists[c]);
+        free_lists[c] = next;
+      }
+    }
+    release_ref();
+  }
+};
+
+// Creates the cache of the thread on first use, and closes it on exit.
+struct thread_cache_holder {
+  thread_cache *cache = new thread_cache;
+  thread_cache_holder() { current_cache = cache; }
+  ~thread_cache_holder() { cache->close(); }
+};
+
+inline thread_cache &local_cache() {
+  thread_local thread_cache_holder holder;
+  return *holder.cache;
+}
+
+} // namespace frame_allocator_detail
+
+struct recycling_frame_allocator {
+  static void *allocate(std::size_t size) {
+    using namespace frame_allocator_detail;
+    std::size_t const total = size + sizeof(block_header);
+    std::size_t const size_class = (total - 1) / class_size;
+    block_header *header;
+    if (size_class >= num_classes) {
+      header = static_cast<block_header *>(::operator new(total));
+      header->owner = nullptr;
+      header->size_class = no_class;
+      return header + 1;
+    }
+
+    thread_cache &cache = local_cache();
+    if (cache.free_lists[size_class] == nullptr) {
+      cache.take_remote();
+    }
+    if (free_block *block = cache.free_lists[size_class]) {
+      cache.free_lists[size_class] = block->next;
+      --cache.free_counts[size_class];
+      header = reinterpret_cast<block_header *>(block);
+    } else {
+      header = static_cast<block_header *>(
+          ::operator new((size_class + 1) * class_size));
+      cache.refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    header->owner = &cache;
+    header->size_class = static_cast<std::uint32_t>(size_class);
+    return header + 1;
+  }
+
+  static void deallocate(void *frame, std::size_t) {
+    using namespace frame_allocator_detail;
+    block_header *const header = static_cast<block_header *>(frame) - 1;
+    if (header->size_class == no_class) {
+      ::operator delete(static_cast<void *>(header));
+      return;
+    }
+    thread_cache *const owner = header->owner;
+    auto *block = reinterpret_cast<free_block *>(header);
+    if (owner == current_cache) {
+      owner->push_local(block, header->size_class);
+    } else {
+      owner->push_remote(block);
+    }
+  }
+
+  static void *operator new(std::size_t size) { return allocate(size); }
+  static void operator delete(void *frame, std::size_t size) {
+    deallocate(frame, size);
+  }
+};
+
+#endif /* FRAME_ALLOCATOR_H_ */
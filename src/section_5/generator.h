@@ -0,0 +1,184 @@
+#ifndef GENERATOR_H_
+#define GENERATOR_H_
+
+#include <coroutine>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <ranges>
+#include <utility>
+
+#include "frame_allocator.h"
+
+// ===================================================================
+// Generator<T>
+// ===================================================================
+// Lazy sequence of values produced with co_yield.
+// - Yielded values are not copied: the promise keeps a pointer to the
+//   yielded object, which lives in the coroutine frame (or is a temporary
+//   of the co_yield expression) until the generator is resumed.
+// - Generators are movable, and are input ranges: they work with range
+//   for, and with std::ranges algorithms and views (as rvalues, through
+//   std::views::all).
+// - A coroutine whose first parameters are (std::allocator_arg_t,
+//   std::pmr::memory_resource &) allocates its frame from that resource,
+//   e.g. a std::pmr::monotonic_buffer_resource over a local buffer. The
+//   resource must outlive the generator. Other frames come from
+//   FrameAllocator (frame_allocator.h).
+// - An exception thrown by the coroutine is rethrown by next() (or by the
+//   iterator increment).
+template <typename T,
+          typename FrameAllocator = default_frame_allocator>
+class Generator {
+public:
+  struct promise_type;
+  class iterator;
+
+  using co_handle = std::coroutine_handle<promise_type>;
+
+  Generator(co_handle handle) : handle_(handle) {}
+  Generator(Generator &&other) noexcept
+      : handle_(std::exchange(other.handle_, {})) {}
+  Generator &operator=(Generator &&other) noexcept {
+    if (this != &other) {
+      if (handle_) {
+        handle_.destroy();
+      }
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+  ~Generator() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  // non-copiable.
+  Generator(Generator const &) = delete;
+  Generator &operator=(Generator const &) = delete;
+
+  // Value of the last co_yield, valid until the next call to next().
+  T const &getValue() const { return *handle_.promise().current_value; }
+
+  // Runs the coroutine up to its next co_yield, returns false when done.
+  bool next() {
+    handle_.resume();
+    if (auto &exception = handle_.promise().exception) {
+      std::rethrow_exception(std::exchange(exception, {}));
+    }
+    return not handle_.done();
+  }
+
+  bool done() const { return handle_.done(); }
+
+  // Starts the coroutine: a generator can only be iterated once.
+  iterator begin() {
+    next();
+    return iterator(this);
+  }
+  std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+  co_handle handle_;
+};
+
+template <typename T, typename FrameAllocator>
+class Generator<T, FrameAllocator>::iterator {
+  Generator *generator = nullptr;
+
+public:
+  using iterator_concept = std::input_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+
+  iterator() = default;
+  explicit iterator(Generator *_generator) : generator(_generator) {}
+
+  T const &operator*() const { return generator->getValue(); }
+  T const *operator->() const { return &generator->getValue(); }
+
+  iterator &operator++() {
+    generator->next();
+    return *this;
+  }
+  void operator++(int) { ++*this; }
+
+  friend bool operator==(iterator const &it, std::default_sentinel_t) {
+    return it.generator->done();
+  }
+};
+
+template <typename T, typename FrameAllocator>
+struct Generator<T, FrameAllocator>::promise_type {
+  using co_handle = std::coroutine_handle<promise_type>;
+
+  auto get_return_object() { return co_handle::from_promise(*this); }
+
+  auto initial_suspend() { return std::suspend_always(); }
+  auto final_suspend() noexcept { return std::suspend_always(); }
+  void return_void() {}
+  void unhandled_exception() { exception = std::current_exception(); }
+
+  // enable co_yield operator. Binds lvalues and temporaries alike: both
+  // outlive the suspension.
+  auto yield_value(T const &value) noexcept {
+    current_value = std::addressof(value);
+    return std::suspend_always();
+  }
+
+  // Frame allocation. Every frame starts with the resource it came from
+  // (nullptr for FrameAllocator), so operator delete can find it.
+  static constexpr std::size_t header_size =
+      __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+  static void *operator new(std::size_t size) {
+    return allocate(size, nullptr);
+  }
+
+  template <typename... Args>
+  static void *operator new(std::size_t size, std::allocator_arg_t,
+                            std::pmr::memory_resource &resource,
+                            Args const &...) {
+    return allocate(size, &resource);
+  }
+
+  // member coroutines: the object comes first.
+  template <typename Object, typename... Args>
+  static void *operator new(std::size_t size, Object const &,
+                            std::allocator_arg_t,
+                            std::pmr::memory_resource &resource,
+                            Args const &...) {
+    return allocate(size, &resource);
+  }
+
+  static void operator delete(void *frame, std::size_t size) {
+    auto *block = static_cast<std::byte *>(frame) - header_size;
+    std::pmr::memory_resource *resource;
+    std::memcpy(&resource, block, sizeof(resource));
+    if (resource != nullptr) {
+      resource->deallocate(block, size + header_size);
+    } else {
+      FrameAllocator::deallocate(block, size + header_size);
+    }
+  }
+
+  T const *current_value = nullptr;
+  std::exception_ptr exception;
+
+private:
+  static void *allocate(std::size_t size,
+                        std::pmr::memory_resource *resource) {
+    void *block = resource != nullptr
+                      ? resource->allocate(size + header_size)
+                      : FrameAllocator::allocate(size + header_size);
+    std::memcpy(block, &resource, sizeof(resource));
+    return static_cast<std::byte *>(block) + header_size;
+  }
+};
+
+#endif /* GENERATOR_H_ */
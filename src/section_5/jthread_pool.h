@@ -0,0 +1,134 @@
+#ifndef JTHREAD_POOL_H_
+#define JTHREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ===================================================================
+// jthread_pool
+// ===================================================================
+// A worker pool on std::jthread, where stopping is immediate:
+// - Idle workers wait on a std::condition_variable_any with their
+//   stop_token: request_stop() wakes them at once, instead of at the end
+//   of a polling interval (see interruptible_counter in 01_jthread.cpp).
+// - Tasks may take a std::stop_token, the token of the worker running
+//   them, to stop early (e.g. with the stop_token waits of
+//   condition_variable_any, as the workers do).
+// - After request_stop(), workers finish their current task and exit:
+//   queued tasks are dropped (their futures get broken_promise).
+// The destructor requests the stop of every worker, then the jthreads
+// join on destruction.
+class jthread_pool {
+  // Move-only, type-erased void(std::stop_token) callable.
+  class stop_task {
+    struct impl_base {
+      virtual void call(std::stop_token token) = 0;
+      virtual ~impl_base() {}
+    };
+
+    template <typename F> struct impl_type : impl_base {
+      F f;
+      impl_type(F &&_f) : f(std::move(_f)) {}
+      void call(std::stop_token token) override {
+        if constexpr (std::is_invocable_v<F &, std::stop_token>) {
+          f(std::move(token));
+        } else {
+          f();
+        }
+      }
+    };
+
+    std::unique_ptr<impl_base> impl;
+
+  public:
+    stop_task() = default;
+
+    template <typename F>
+      requires(!std::is_same_v<std::decay_t<F>, stop_task>)
+    stop_task(F &&f)
+        : impl(new impl_type<std::decay_t<F>>(std::forward<F>(f))) {}
+
+    void operator()(std::stop_token token) { impl->call(std::move(token)); }
+  };
+
+  std::mutex mutex;
+  std::condition_variable_any cv;
+  std::deque<stop_task> queue;
+  std::vector<std::jthread> workers; // last: joined first
+
+  void worker_thread(std::stop_token token) {
+    while (true) {
+      stop_task task;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, token, [this] { return !queue.empty(); });
+        if (token.stop_requested()) {
+          return;
+        }
+        task = std::move(queue.front());
+        queue.pop_front();
+      }
+      task(token);
+    }
+  }
+
+public:
+  static unsigned default_thread_count() {
+    unsigned const hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads != 0 ? hardware_threads : 2;
+  }
+
+  // If a thread fails to start, the ones already started are stopped and
+  // joined by their jthread destructors.
+  explicit jthread_pool(unsigned thread_count = default_thread_count()) {
+    for (unsigned i = 0; i < thread_count; ++i) {
+      workers.emplace_back(
+          [this](std::stop_token token) { worker_thread(std::move(token)); });
+    }
+  }
+
+  ~jthread_pool() { request_stop(); }
+
+  // non-copiable.
+  jthread_pool(jthread_pool const &) = delete;
+  jthread_pool &operator=(jthread_pool const &) = delete;
+
+  std::size_t size() const { return workers.size(); }
+
+  // Stops every worker, without waiting for them.
+  void request_stop() {
+    for (auto &w : workers) {
+      w.request_stop();
+    }
+  }
+
+  // f() or f(std::stop_token), fire and forget.
+  template <typename F> void post(F &&f) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.emplace_back(std::forward<F>(f));
+    }
+    cv.notify_one();
+  }
+
+  // f(), with a future for its result.
+  template <typename F>
+  std::future<std::invoke_result_t<std::decay_t<F> &>> submit(F &&f) {
+    using result_type = std::invoke_result_t<std::decay_t<F> &>;
+    std::packaged_task<result_type()> task(std::forward<F>(f));
+    std::future<result_type> result(task.get_future());
+    post(std::move(task));
+    return result;
+  }
+};
+
+#endif /* JTHREAD_POOL_H_ */
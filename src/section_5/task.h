@@ -0,0 +1,267 @@
+#ifndef TASK_H_
+#define TASK_H_
+
+#include <cassert>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "frame_allocator.h"
+
+// ===================================================================
+// Lazy coroutine task<T>
+// ===================================================================
+// Unlike resumable (02_coroutines.cpp), a task is not resumed by hand:
+// - it starts when it is co_awaited, and the awaiting coroutine resumes
+//   when it completes, with its co_return value (or its exception).
+// - Both switches use symmetric transfer: await_suspend returns the
+//   handle to run next, instead of calling resume() on it. The compiler
+//   turns it into a tail call (gcc: when optimizing), so a task awaiting a
+//   million tasks that complete synchronously (or a recursion a million
+//   tasks deep) does not grow the stack.
+// - sync_wait(task) runs a task from a regular thread and blocks until it
+//   completes. spawn(task) starts it and lets it run on its own.
+// - Inside a task, co_await pool.schedule() (section_8/thread_pool.h)
+//   moves the rest of the coroutine onto a worker of the pool.
+// The task owns its frame: destroying it destroys the coroutine. Frames
+// come from FrameAllocator (frame_allocator.h).
+template <typename T = void,
+          typename FrameAllocator = default_frame_allocator>
+class task;
+
+namespace task_detail {
+
+// What every promise has: the coroutine to resume on completion, and the
+// exception, if any.
+struct promise_base {
+  std::coroutine_handle<> continuation = std::noop_coroutine();
+  std::exception_ptr exception;
+
+  // On completion, transfer to the awaiting coroutine.
+  struct final_awaiter {
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+      return handle.promise().continuation;
+    }
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  final_awaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() noexcept {
+    exception = std::current_exception();
+  }
+
+  void rethrow_if_exception() {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+};
+
+template <typename T, typename FrameAllocator>
+struct promise : promise_base, FrameAllocator {
+  std::optional<T> value;
+
+  task<T, FrameAllocator> get_return_object() noexcept;
+
+  template <typename U>
+    requires std::is_convertible_v<U &&, T>
+  void return_value(U &&u) {
+    value.emplace(std::forward<U>(u));
+  }
+
+  T result() {
+    rethrow_if_exception();
+    return std::move(*value);
+  }
+};
+
+template <typename FrameAllocator>
+struct promise<void, FrameAllocator> : promise_base, FrameAllocator {
+  task<void, FrameAllocator> get_return_object() noexcept;
+  void return_void() const noexcept {}
+  void result() { rethrow_if_exception(); }
+};
+
+} // namespace task_detail
+
+template <typename T, typename FrameAllocator> class [[nodiscard]] task {
+public:
+  using promise_type = task_detail::promise<T, FrameAllocator>;
+  using co_handle = std::coroutine_handle<promise_type>;
+
+  explicit task(co_handle _handle) : handle(_handle) {}
+  task(task &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+  task &operator=(task &&other) noexcept {
+    if (this != &other) {
+      if (handle) {
+        handle.destroy();
+      }
+      handle = std::exchange(other.handle, {});
+    }
+    return *this;
+  }
+  ~task() {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+
+  // non-copiable.
+  task(task const &) = delete;
+  task &operator=(task const &) = delete;
+
+  // Starts the task: the awaiting coroutine is suspended, and resumed with
+  // the result once the task completes. The task must not be empty (moved
+  // from).
+  auto operator co_await() && noexcept {
+    assert(handle && "co_await on an empty task");
+    struct awaiter {
+      co_handle handle;
+
+      bool await_ready() const noexcept { return handle.done(); }
+      std::coroutine_handle<>
+      await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      T await_resume() { return handle.promise().result(); }
+    };
+    return awaiter{handle};
+  }
+
+private:
+  co_handle handle;
+};
+
+namespace task_detail {
+
+template <typename T, typename FrameAllocator>
+task<T, FrameAllocator>
+promise<T, FrameAllocator>::get_return_object() noexcept {
+  return task<T, FrameAllocator>(
+      std::coroutine_handle<promise>::from_promise(*this));
+}
+
+template <typename FrameAllocator>
+task<void, FrameAllocator>
+promise<void, FrameAllocator>::get_return_object() noexcept {
+  return task<void, FrameAllocator>(
+      std::coroutine_handle<promise>::from_promise(*this));
+}
+
+// The flag is set and signalled under the mutex: once sync_wait sees it,
+// the coroutine no longer touches the state.
+struct sync_wait_state {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+};
+
+// Coroutine that awaits a task, then wakes the thread blocked in
+// sync_wait. Started and destroyed by sync_wait.
+struct sync_wait_task {
+  struct promise_type {
+    sync_wait_state *state = nullptr;
+
+    sync_wait_task get_return_object() noexcept {
+      return {std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    auto final_suspend() noexcept {
+      struct notifier {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(
+            std::coroutine_handle<promise_type> handle) const noexcept {
+          sync_wait_state &state = *handle.promise().state;
+          std::lock_guard<std::mutex> lock(state.mutex);
+          state.done = true;
+          state.cv.notify_one();
+        }
+        void await_resume() const noexcept {}
+      };
+      return notifier{};
+    }
+    void return_void() const noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+// Not a lambda: the captures of a lambda coroutine die with the lambda,
+// parameters live in the frame.
+template <typename T, typename FrameAllocator, typename Result>
+sync_wait_task await_into(task<T, FrameAllocator> &t,
+                          std::optional<Result> &result,
+                          std::exception_ptr &exception) {
+  try {
+    if constexpr (std::is_void_v<T>) {
+      co_await std::move(t);
+      result.emplace(true);
+    } else {
+      result.emplace(co_await std::move(t));
+    }
+  } catch (...) {
+    exception = std::current_exception();
+  }
+}
+
+// Fire and forget coroutine: starts at once, frees its frame on return.
+struct detached {
+  struct promise_type {
+    detached get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+template <typename T, typename FrameAllocator>
+detached run_detached(task<T, FrameAllocator> t) {
+  co_await std::move(t);
+}
+
+} // namespace task_detail
+
+// Starts t on the calling thread, up to its first suspension, and returns.
+// Nobody awaits it: its frame is freed when it completes, and an exception
+// escaping it terminates the program.
+template <typename T, typename FrameAllocator>
+void spawn(task<T, FrameAllocator> t) {
+  task_detail::run_detached(std::move(t));
+}
+
+// Runs t to completion from a thread that is not a coroutine, and returns
+// its result. Blocks while the task runs on other threads.
+template <typename T, typename FrameAllocator>
+T sync_wait(task<T, FrameAllocator> t) {
+  using namespace task_detail;
+  std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> result;
+  std::exception_ptr exception;
+  sync_wait_state state;
+  sync_wait_task waiter = await_into(t, result, exception);
+  waiter.handle.promise().state = &state;
+  waiter.handle.resume();
+  {
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.cv.wait(lock, [&state] { return state.done; });
+  }
+  waiter.handle.destroy();
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+  if constexpr (!std::is_void_v<T>) {
+    return std::move(*result);
+  }
+}
+
+#endif /* TASK_H_ */
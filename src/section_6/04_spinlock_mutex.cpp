@@ -1,35 +1,39 @@
-#include <atomic>
+#include <time.h>
+
 #include <chrono>
 #include <iostream>
 #include <mutex>
 #include <thread>
 
-class spinlock_mutex {
-  std::atomic_flag flag = ATOMIC_FLAG_INIT;
-
-public:
-  spinlock_mutex() {}
-
-  void lock() {
-    while (flag.test_and_set(std::memory_order_acquire))
-      ;
-  }
-
-  void unlock() { flag.clear(std::memory_order_release); }
-};
-
-spinlock_mutex mutex;
+#include "adaptive_mutex.h"
+#include "spinlock_mutex.h"
 
-void func() {
-  std::lock_guard<spinlock_mutex> lock(mutex);
-  std::cout << "hello from id: " << std::this_thread::get_id() << std::endl;
-  std::this_thread::sleep_for(std::chrono::seconds(3));
+double process_cpu_seconds() {
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
 }
 
-int main() {
+// Two threads hold the lock for 3 s each: the second one waits 3 s, by
+// spinning (spinlock_mutex) or sleeping (adaptive_mutex).
+template <typename Mutex> void run(const char *name) {
+  Mutex mutex;
+  auto func = [&mutex] {
+    std::lock_guard<Mutex> lock(mutex);
+    std::cout << "hello from id: " << std::this_thread::get_id() << std::endl;
+    std::this_thread::sleep_for(std::chrono::seconds(3));
+  };
+  double const cpu = process_cpu_seconds();
   std::thread thread_1(func);
   std::thread thread_2(func);
   thread_1.join();
   thread_2.join();
+  std::cout << name << ": " << process_cpu_seconds() - cpu
+            << " s of CPU time" << std::endl;
+}
+
+int main() {
+  run<spinlock_mutex>("spinlock_mutex");
+  run<adaptive_mutex>("adaptive_mutex");
   return 0;
 }
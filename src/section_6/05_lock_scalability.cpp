@@ -0,0 +1,140 @@
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "adaptive_mutex.h"
+#include "fair_locks.h"
+#include "spin_hints.h"
+#include "spinlock_mutex.h"
+
+using namespace std::literals;
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+using spin_hints::cache_line_size;
+
+// Per-thread counters, in their own cache lines (no false sharing).
+struct alignas(cache_line_size) padded_count {
+  std::uint64_t value = 0;
+  std::uint64_t sink = 0; // result of the non-critical work
+};
+
+double process_cpu_seconds() {
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// steps of a linear congruential generator: a few ns of dependent work
+// each, that the compiler cannot remove.
+inline void work(std::uint64_t &value, unsigned steps) {
+  for (unsigned i = 0; i < steps; ++i) {
+    value = value * 6364136223846793005u + 1442695040888963407u;
+  }
+}
+
+// Prints benchmark results, as acquisitions per second, CPU cores used
+// (CPU time / wall time) and fairness: the spread of the acquisitions of
+// each thread, (max - min) / mean. 0% when every thread got its share.
+void print_results(const char *const tag,
+                   std::vector<std::uint64_t> const &counts,
+                   double cpu_seconds, bool correct,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  double const seconds = duration<double>(endTime - startTime).count();
+  std::uint64_t total = 0;
+  for (std::uint64_t c : counts) {
+    total += c;
+  }
+  auto const [min, max] = std::minmax_element(counts.begin(), counts.end());
+  double const mean = static_cast<double>(total) / counts.size();
+  printf("%s: %12.0f acquisitions/s, CPU %5.2f cores, spread %6.1f%% %s\n",
+         tag, total / seconds, cpu_seconds / seconds,
+         mean > 0 ? (*max - *min) / mean * 100 : 0.0,
+         correct ? "" : "WRONG RESULT");
+}
+
+// ===================================================================
+// BENCHMARK: threads taking the same lock, for a fixed time
+// ===================================================================
+// Each thread loops: lock, count the acquisition and run the critical
+// section (cs_steps on the protected value), unlock, then a short
+// non-critical section.
+template <typename Mutex>
+void run(const char *name, unsigned threads, unsigned cs_steps,
+         std::chrono::milliseconds run_time) {
+  constexpr unsigned outside_steps = 100;
+  Mutex mutex;
+  std::uint64_t acquisitions = 0; // protected by mutex
+  std::uint64_t value = 1;        // protected by mutex
+  std::vector<padded_count> counts(threads);
+  std::atomic<bool> go{false};
+  std::atomic<bool> stop{false};
+
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      std::uint64_t local = t;
+      go.wait(false);
+      while (!stop.load(std::memory_order_relaxed)) {
+        {
+          std::lock_guard<Mutex> lock(mutex);
+          ++acquisitions;
+          work(value, cs_steps);
+        }
+        ++counts[t].value;
+        work(local, outside_steps);
+      }
+      counts[t].sink = local;
+    });
+  }
+
+  double const cpu = process_cpu_seconds();
+  auto startTime = high_resolution_clock::now();
+  go.store(true);
+  go.notify_all();
+  std::this_thread::sleep_for(run_time);
+  stop.store(true);
+  for (auto &w : workers) {
+    w.join();
+  }
+  auto endTime = high_resolution_clock::now();
+  double const cpu_seconds = process_cpu_seconds() - cpu;
+
+  std::vector<std::uint64_t> per_thread;
+  std::uint64_t total = 0;
+  for (auto const &c : counts) {
+    per_thread.push_back(c.value);
+    total += c.value;
+  }
+  std::string tag = std::string(name) + ", " + std::to_string(threads) +
+                    " thread(s)";
+  tag.resize(30, ' ');
+  print_results(tag.c_str(), per_thread, cpu_seconds, total == acquisitions,
+                startTime, endTime);
+}
+
+int main(int argc, char **argv) {
+  const unsigned max_threads = argc > 1 ? std::stoul(argv[1]) : 64;
+  constexpr auto run_time = 200ms;
+
+  for (unsigned cs_steps : {0, 100, 10'000}) {
+    printf("\nCritical section of %u steps...\n", cs_steps);
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+      run<std::mutex>("std::mutex", threads, cs_steps, run_time);
+      run<spinlock_mutex>("spinlock_mutex", threads, cs_steps, run_time);
+      run<adaptive_mutex>("adaptive_mutex", threads, cs_steps, run_time);
+      run<ticket_lock>("ticket_lock", threads, cs_steps, run_time);
+      run<mcs_lock>("mcs_lock", threads, cs_steps, run_time);
+    }
+  }
+  return 0;
+}
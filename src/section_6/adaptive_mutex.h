@@ -0,0 +1,91 @@
+#ifndef ADAPTIVE_MUTEX_H_
+#define ADAPTIVE_MUTEX_H_
+
+#include <atomic>
+
+#include "spin_hints.h"
+
+// ===================================================================
+// adaptive_mutex: spin, then park
+// ===================================================================
+// A lock for both short and long critical sections, usable with
+// std::lock_guard:
+// - Spinning: test-and-test-and-set. Waiters read the state, which keeps
+//   the cache line shared, and only try the exchange when it is unlocked.
+//   Between reads they pause, twice as long each round (exponential
+//   backoff), so that they do not all rush at the line at every unlock.
+// - Parking: when the owner does not unlock within the spinning budget,
+//   the waiter sleeps with atomic::wait (a futex on Linux) and costs no
+//   CPU until it is woken.
+// The state is 0 (unlocked), 1 (locked) or 2 (locked, maybe with parked
+// waiters): unlock() only makes the notify system call in state 2 (see
+// Drepper, "Futexes Are Tricky").
+class adaptive_mutex {
+  static constexpr unsigned unlocked = 0;
+  static constexpr unsigned locked = 1;
+  static constexpr unsigned contended = 2;
+
+  // Spinning budget: backoff rounds of 1, 2, 4... max_backoff pauses, 319
+  // pauses in total (a few microseconds, depending on the CPU).
+  static constexpr unsigned spin_rounds = 10;
+  static constexpr unsigned max_backoff = 64;
+
+  std::atomic<unsigned> state{unlocked};
+
+  void lock_slow() {
+    unsigned backoff = 1;
+    for (unsigned round = 0; round < spin_rounds; ++round) {
+      for (unsigned i = 0; i < backoff; ++i) {
+        spin_hints::cpu_relax();
+      }
+      if (backoff < max_backoff) {
+        backoff *= 2;
+      }
+      unsigned s = state.load(std::memory_order_relaxed);
+      if (s == contended) {
+        break; // others are parked already: spinning would jump the queue
+      }
+      if (s == unlocked &&
+          state.compare_exchange_weak(s, locked, std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+        return;
+      }
+    }
+    // Locked in state 2, as there may be other parked waiters to wake.
+    while (state.exchange(contended, std::memory_order_acquire) !=
+           unlocked) {
+      state.wait(contended, std::memory_order_relaxed);
+    }
+  }
+
+public:
+  adaptive_mutex() {}
+
+  // non-copiable.
+  adaptive_mutex(adaptive_mutex const &) = delete;
+  adaptive_mutex &operator=(adaptive_mutex const &) = delete;
+
+  void lock() {
+    unsigned expected = unlocked;
+    if (!state.compare_exchange_strong(expected, locked,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+      lock_slow();
+    }
+  }
+
+  bool try_lock() {
+    unsigned expected = unlocked;
+    return state.compare_exchange_strong(expected, locked,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed);
+  }
+
+  void unlock() {
+    if (state.exchange(unlocked, std::memory_order_release) == contended) {
+      state.notify_one();
+    }
+  }
+};
+
+#endif /* ADAPTIVE_MUTEX_H_ */
@@ -0,0 +1,148 @@
+#ifndef FAIR_LOCKS_H_
+#define FAIR_LOCKS_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "spin_hints.h"
+
+// ===================================================================
+// Fair locks: ticket_lock and mcs_lock
+// ===================================================================
+// spinlock_mutex (and std::mutex) let whoever is fastest take the lock
+// at unlock: under contention, the thread that just unlocked often takes
+// it again, and others starve. These two locks serve waiters in arrival
+// order (FIFO), and are usable with std::lock_guard.
+// - ticket_lock: take a ticket, wait until it is served. Every waiter
+//   reads the same counter, which is invalidated at each handoff.
+// - mcs_lock (Mellor-Crummey and Scott): waiters form a queue, and each
+//   one spins on its own node, in its own cache line. The owner hands the
+//   lock to its successor by writing to the successor's node only.
+// Waiters pause while they spin, then yield the CPU, so that the thread
+// whose turn it is can run when there are more threads than cores.
+class ticket_lock {
+  // Apart, so taking a ticket does not disturb the waiters.
+  alignas(spin_hints::cache_line_size) std::atomic<unsigned> next_ticket{0};
+  alignas(spin_hints::cache_line_size) std::atomic<unsigned> now_serving{0};
+
+public:
+  ticket_lock() {}
+
+  // non-copiable.
+  ticket_lock(ticket_lock const &) = delete;
+  ticket_lock &operator=(ticket_lock const &) = delete;
+
+  void lock() {
+    unsigned const ticket =
+        next_ticket.fetch_add(1, std::memory_order_relaxed);
+    spin_hints::spin_wait w;
+    while (now_serving.load(std::memory_order_acquire) != ticket) {
+      w.wait();
+    }
+  }
+
+  // Only when nobody holds or waits for the lock.
+  bool try_lock() {
+    unsigned const serving = now_serving.load(std::memory_order_acquire);
+    unsigned ticket = serving;
+    return next_ticket.compare_exchange_strong(ticket, serving + 1,
+                                               std::memory_order_relaxed);
+  }
+
+  void unlock() {
+    now_serving.store(now_serving.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_release);
+  }
+};
+
+class mcs_lock {
+  struct alignas(spin_hints::cache_line_size) node {
+    std::atomic<node *> next{nullptr};
+    std::atomic<bool> waiting{false};
+  };
+
+  // lock() takes no argument, for std::lock_guard: queue nodes come from
+  // a free list per thread, and go back to it at unlock, when the
+  // successor does not use them any more. A thread may hold several
+  // locks, and release them in any order.
+  static std::vector<std::unique_ptr<node>> &free_nodes() {
+    thread_local std::vector<std::unique_ptr<node>> nodes;
+    return nodes;
+  }
+
+  static node *acquire_node() {
+    auto &nodes = free_nodes();
+    if (nodes.empty()) {
+      return new node;
+    }
+    node *n = nodes.back().release();
+    nodes.pop_back();
+    return n;
+  }
+
+  static void release_node(node *n) { free_nodes().emplace_back(n); }
+
+  alignas(spin_hints::cache_line_size) std::atomic<node *> tail{nullptr};
+  node *owner = nullptr; // node of the holder, only used by the holder
+
+public:
+  mcs_lock() {}
+
+  // non-copiable.
+  mcs_lock(mcs_lock const &) = delete;
+  mcs_lock &operator=(mcs_lock const &) = delete;
+
+  void lock() {
+    node *n = acquire_node();
+    n->next.store(nullptr, std::memory_order_relaxed);
+    n->waiting.store(true, std::memory_order_relaxed);
+    node *const predecessor = tail.exchange(n, std::memory_order_acq_rel);
+    if (predecessor != nullptr) {
+      predecessor->next.store(n, std::memory_order_release);
+      spin_hints::spin_wait w;
+      while (n->waiting.load(std::memory_order_acquire)) {
+        w.wait();
+      }
+    }
+    owner = n;
+  }
+
+  bool try_lock() {
+    node *n = acquire_node();
+    n->next.store(nullptr, std::memory_order_relaxed);
+    node *expected = nullptr;
+    if (!tail.compare_exchange_strong(expected, n,
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_relaxed)) {
+      release_node(n);
+      return false;
+    }
+    owner = n;
+    return true;
+  }
+
+  void unlock() {
+    node *const n = owner;
+    node *successor = n->next.load(std::memory_order_acquire);
+    if (successor == nullptr) {
+      node *expected = n;
+      if (tail.compare_exchange_strong(expected, nullptr,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+        release_node(n); // no waiter
+        return;
+      }
+      // a waiter has joined the queue, but not linked itself yet.
+      spin_hints::spin_wait w;
+      while ((successor = n->next.load(std::memory_order_acquire)) ==
+             nullptr) {
+        w.wait();
+      }
+    }
+    successor->waiting.store(false, std::memory_order_release);
+    release_node(n);
+  }
+};
+
+#endif /* FAIR_LOCKS_H_ */
@@ -0,0 +1,43 @@
+#ifndef SPIN_HINTS_H_
+#define SPIN_HINTS_H_
+
+#include <cstddef>
+#include <thread>
+
+// ===================================================================
+// Helpers for spinning threads and padded data
+// ===================================================================
+// Shared by the locks of this section and by the other sections, in the
+// spin_hints namespace.
+namespace spin_hints {
+
+// Typical cache line size for x86_64 and most ARM cores.
+// std::hardware_destructive_interference_size is not used, as gcc warns
+// about its value not being ABI stable.
+constexpr std::size_t cache_line_size = 64;
+
+// Hints the CPU that we are in a spin-wait loop.
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+// Spins for a while, then gives the CPU away. Keeps the latency low when
+// the other side is running, without starving it when it is not.
+class spin_wait {
+  unsigned count = 0;
+
+public:
+  void wait() {
+    if (++count < 64) {
+      cpu_relax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+};
+
+} // namespace spin_hints
+
+#endif /* SPIN_HINTS_H_ */
@@ -0,0 +1,27 @@
+#ifndef SPINLOCK_MUTEX_H_
+#define SPINLOCK_MUTEX_H_
+
+#include <atomic>
+
+// ===================================================================
+// spinlock_mutex
+// ===================================================================
+// The simplest lock: test_and_set until the flag was clear. Waiters never
+// sleep and never back off: each try is a write that takes the cache line
+// from the owner and from the other waiters. See adaptive_mutex.h for a
+// lock that does not burn a core while it waits.
+class spinlock_mutex {
+  std::atomic_flag flag = ATOMIC_FLAG_INIT;
+
+public:
+  spinlock_mutex() {}
+
+  void lock() {
+    while (flag.test_and_set(std::memory_order_acquire))
+      ;
+  }
+
+  void unlock() { flag.clear(std::memory_order_release); }
+};
+
+#endif /* SPINLOCK_MUTEX_H_ */
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "section_6/spin_hints.h"
+
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+// ===================================================================
+// Helper Elements
+// ===================================================================
+using spin_hints::cache_line_size;
+using spin_hints::spin_wait;
+
+// A sequence number living alone in its own cache line, so that the
+// producer and every consumer can update their own counter without
+// invalidating each other's caches (false sharing).
+struct alignas(cache_line_size) padded_sequence {
+  std::atomic<std::int64_t> value{-1};
+};
+
+// ===================================================================
+// Single Producer Multi Consumer Broadcast Ring (disruptor style)
+// ===================================================================
+// Every consumer receives every published value, in order.
+// - The producer owns the cursor: the last published sequence.
+// - Each consumer owns its sequence: the last consumed sequence.
+// - The producer cannot overwrite a slot until the slowest consumer has
+//   consumed it, so the slowest consumer provides backpressure.
+// - Consumers read every available slot in a single batch, and publish
+//   their progress once per batch.
+// Sequences only grow, the slot is found by masking with Capacity - 1.
+template <typename T, std::size_t Capacity> class broadcast_ring {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+
+  static constexpr std::int64_t mask = Capacity - 1;
+
+  std::unique_ptr<T[]> buffer;
+  std::unique_ptr<padded_sequence[]> consumers;
+  std::size_t const consumer_count;
+
+  padded_sequence cursor;
+
+  // producer-only state, kept away from the shared cursor.
+  struct alignas(cache_line_size) producer_state {
+    std::int64_t next = 0;
+    std::int64_t cached_gating = -1;
+  } producer;
+
+  std::int64_t slowest_consumer() const {
+    std::int64_t minimum = cursor.value.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < consumer_count; ++i) {
+      std::int64_t const seq =
+          consumers[i].value.load(std::memory_order_acquire);
+      minimum = std::min(minimum, seq);
+    }
+    return minimum;
+  }
+
+public:
+  explicit broadcast_ring(std::size_t _consumer_count)
+      : buffer(new T[Capacity]),
+        consumers(new padded_sequence[_consumer_count]),
+        consumer_count(_consumer_count) {}
+
+  broadcast_ring(broadcast_ring const &) = delete;
+  broadcast_ring &operator=(broadcast_ring const &) = delete;
+
+  // Producer side: waits until the slowest consumer frees the slot.
+  void publish(T const &value) {
+    std::int64_t const seq = producer.next++;
+    std::int64_t const wrap_point =
+        seq - static_cast<std::int64_t>(Capacity);
+
+    // Only read the consumer sequences when the cached value is not enough.
+    if (wrap_point > producer.cached_gating) {
+      spin_wait waiter;
+      while (wrap_point > (producer.cached_gating = slowest_consumer())) {
+        waiter.wait();
+      }
+    }
+
+    buffer[seq & mask] = value;
+    cursor.value.store(seq, std::memory_order_release);
+  }
+
+  // Consumer side: calls handler(value, sequence) for every available value
+  // and returns the number of consumed values (0 if nothing was available).
+  template <typename Handler>
+  std::size_t try_consume(std::size_t consumer, Handler &&handler) {
+    padded_sequence &own = consumers[consumer];
+    std::int64_t const last = own.value.load(std::memory_order_relaxed);
+    std::int64_t const available =
+        cursor.value.load(std::memory_order_acquire);
+    if (available <= last) {
+      return 0;
+    }
+
+    for (std::int64_t seq = last + 1; seq <= available; ++seq) {
+      handler(buffer[seq & mask], seq);
+    }
+
+    // release the whole batch to the producer at once.
+    own.value.store(available, std::memory_order_release);
+    return available - last;
+  }
+
+  // Consumer side: blocks (spinning) until at least one value is available.
+  template <typename Handler>
+  std::size_t consume(std::size_t consumer, Handler &&handler) {
+    spin_wait waiter;
+    std::size_t count;
+    while ((count = try_consume(consumer, handler)) == 0) {
+      waiter.wait();
+    }
+    return count;
+  }
+};
+
+// ===================================================================
+// Benchmark: messages/sec for 1-16 consumers
+// ===================================================================
+struct message {
+  std::int64_t value;
+  std::int64_t timestamp;
+};
+
+constexpr std::size_t ring_capacity = 1 << 14;
+
+void run_benchmark(std::size_t consumer_count, std::int64_t message_count) {
+  broadcast_ring<message, ring_capacity> ring(consumer_count);
+
+  std::vector<std::int64_t> sums(consumer_count, 0);
+  std::vector<std::size_t> batches(consumer_count, 0);
+  std::vector<std::thread> threads;
+
+  auto const startTime = high_resolution_clock::now();
+
+  for (std::size_t c = 0; c < consumer_count; ++c) {
+    threads.emplace_back([&, c]() {
+      std::int64_t sum = 0;
+      std::int64_t last_seq = -1;
+      std::size_t batch_count = 0;
+      while (last_seq < message_count - 1) {
+        ring.consume(c, [&](message const &msg, std::int64_t seq) {
+          sum += msg.value;
+          last_seq = seq;
+        });
+        ++batch_count;
+      }
+      sums[c] = sum;
+      batches[c] = batch_count;
+    });
+  }
+
+  for (std::int64_t i = 0; i < message_count; ++i) {
+    ring.publish(message{i, i});
+  }
+
+  for (auto &t : threads) {
+    t.join();
+  }
+  auto const endTime = high_resolution_clock::now();
+
+  // every consumer must have seen every message.
+  std::int64_t const expected = message_count * (message_count - 1) / 2;
+  bool ok = true;
+  std::size_t total_batches = 0;
+  for (std::size_t c = 0; c < consumer_count; ++c) {
+    ok = ok && (sums[c] == expected);
+    total_batches += batches[c];
+  }
+
+  double const seconds = duration<double>(endTime - startTime).count();
+  printf("consumers: %2zu  messages/sec: %12.0f  deliveries/sec: %12.0f  "
+         "avg batch: %8.1f  %s\n",
+         consumer_count, message_count / seconds,
+         message_count * consumer_count / seconds,
+         static_cast<double>(message_count * consumer_count) / total_batches,
+         ok ? "ok" : "MISMATCH");
+}
+
+int main(int argc, char **argv) {
+  std::int64_t const message_count =
+      argc > 1 ? std::stoll(argv[1]) : 10'000'000;
+
+  printf("Broadcasting %lld messages, ring capacity %zu\n",
+         static_cast<long long>(message_count), ring_capacity);
+  for (std::size_t consumers : {1, 2, 4, 8, 16}) {
+    run_benchmark(consumers, message_count);
+  }
+  return 0;
+}
@@ -0,0 +1,458 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thread_pool.h"
+
+using namespace std::literals;
+using std::milli;
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+// ===================================================================
+// Hierarchical Timer Wheel
+// ===================================================================
+// A single timer thread keeps every pending timer, and hands the expired
+// callbacks to a thread_pool. This replaces the "sleep_for inside a task"
+// pattern, which blocks one thread per pending timer.
+//
+// Time is divided in ticks. The wheel has 4 levels of 256 slots each:
+// - Level 0 holds timers expiring in the next 256 ticks, one slot per tick.
+// - Level L holds timers expiring within 256^(L+1) ticks, one slot per
+//   256^L ticks. When level L-1 wraps around, the next slot of level L is
+//   cascaded: its timers are re-inserted into the lower levels.
+// Every slot is an intrusive doubly linked list, so schedule() and cancel()
+// are O(1). Timers are stored by index in a node vector with a free list,
+// and the id carries a generation counter to detect stale cancellations.
+class timer_wheel {
+public:
+  using clock = std::chrono::steady_clock;
+  using callback = std::function<void()>;
+
+  struct timer_id {
+    std::uint32_t index;
+    std::uint32_t generation;
+  };
+
+private:
+  static constexpr unsigned level_bits = 8;
+  static constexpr unsigned slots_per_level = 1u << level_bits;
+  static constexpr unsigned slot_mask = slots_per_level - 1;
+  static constexpr unsigned levels = 4;
+  static constexpr std::uint64_t max_delta =
+      (std::uint64_t(1) << (levels * level_bits)) - 1;
+  static constexpr std::uint32_t npos = UINT32_MAX;
+
+  struct node {
+    callback cb;
+    std::uint64_t expires = 0;
+    std::uint64_t period = 0; // 0 for one-shot timers
+    std::uint32_t generation = 0;
+    std::uint32_t prev = npos;
+    std::uint32_t next = npos;
+    std::uint32_t slot = npos; // level * slots_per_level + slot; npos if free
+  };
+
+  thread_pool &pool;
+  clock::duration const tick;
+  clock::time_point const start;
+
+  mutable std::mutex mutex;
+  std::condition_variable cv;
+  bool stop = false;
+
+  std::vector<node> nodes;
+  std::uint32_t free_list = npos;
+  std::array<std::uint32_t, levels * slots_per_level> slots;
+  std::uint64_t current_tick = 0;
+  std::size_t pending_count = 0;
+
+  std::thread timer_thread;
+
+  // ---------------------------------------------------------------
+  // Slot lists (mutex held)
+  // ---------------------------------------------------------------
+  void link(std::uint32_t index) {
+    node &n = nodes[index];
+    std::uint64_t delta = n.expires - current_tick;
+    // beyond the range of the wheel: parked in the top level slot of the
+    // furthest tick it can hold, and linked again when that slot is
+    // cascaded. n.expires is kept, so that the timer never fires early.
+    std::uint64_t placed = n.expires;
+    if (delta > max_delta) {
+      delta = max_delta;
+      placed = current_tick + max_delta;
+    }
+
+    unsigned level = 0;
+    while (level + 1 < levels &&
+           delta >= (std::uint64_t(1) << ((level + 1) * level_bits))) {
+      ++level;
+    }
+    unsigned const slot =
+        level * slots_per_level +
+        ((placed >> (level * level_bits)) & slot_mask);
+
+    n.slot = slot;
+    n.prev = npos;
+    n.next = slots[slot];
+    if (n.next != npos) {
+      nodes[n.next].prev = index;
+    }
+    slots[slot] = index;
+  }
+
+  void unlink(std::uint32_t index) {
+    node &n = nodes[index];
+    if (n.prev != npos) {
+      nodes[n.prev].next = n.next;
+    } else {
+      slots[n.slot] = n.next;
+    }
+    if (n.next != npos) {
+      nodes[n.next].prev = n.prev;
+    }
+    n.prev = n.next = n.slot = npos;
+  }
+
+  std::uint32_t allocate() {
+    if (free_list != npos) {
+      std::uint32_t const index = free_list;
+      free_list = nodes[index].next;
+      nodes[index].next = npos;
+      return index;
+    }
+    nodes.emplace_back();
+    return static_cast<std::uint32_t>(nodes.size() - 1);
+  }
+
+  void release(std::uint32_t index) {
+    node &n = nodes[index];
+    n.cb = nullptr;
+    ++n.generation; // invalidates outstanding timer_ids
+    n.next = free_list;
+    free_list = index;
+    --pending_count;
+  }
+
+  // ---------------------------------------------------------------
+  // Time keeping (mutex held)
+  // ---------------------------------------------------------------
+  std::uint64_t ticks_at(clock::time_point t) const {
+    return static_cast<std::uint64_t>((t - start) / tick);
+  }
+
+  // Number of ticks until something can happen: the next non empty level 0
+  // slot, or the next cascade.
+  std::uint64_t ticks_to_next_event() const {
+    unsigned const offset = current_tick & slot_mask;
+    for (unsigned i = 1; offset + i < slots_per_level; ++i) {
+      if (slots[(offset + i) & slot_mask] != npos) {
+        return i;
+      }
+    }
+    return slots_per_level - offset;
+  }
+
+  // Cascades every timer in the given slot down to the lower levels.
+  void cascade(unsigned level, unsigned slot) {
+    std::uint32_t index = slots[level * slots_per_level + slot];
+    slots[level * slots_per_level + slot] = npos;
+    while (index != npos) {
+      std::uint32_t const next = nodes[index].next;
+      link(index);
+      index = next;
+    }
+  }
+
+  // Advances the wheel a single tick, collecting the expired callbacks.
+  void advance(std::vector<callback> &expired) {
+    ++current_tick;
+
+    // Cascade from the highest wrapped level down, so that timers moving
+    // down several levels end up in level 0 within this same tick.
+    unsigned wrapped = 0;
+    while (wrapped + 1 < levels &&
+           (current_tick &
+            ((std::uint64_t(1) << ((wrapped + 1) * level_bits)) - 1)) == 0) {
+      ++wrapped;
+    }
+    for (unsigned level = wrapped; level > 0; --level) {
+      cascade(level, (current_tick >> (level * level_bits)) & slot_mask);
+    }
+
+    std::uint32_t index = slots[current_tick & slot_mask];
+    slots[current_tick & slot_mask] = npos;
+    while (index != npos) {
+      node &n = nodes[index];
+      std::uint32_t const next = n.next;
+      n.prev = n.next = n.slot = npos;
+      if (n.period != 0) {
+        expired.push_back(n.cb); // periodic timers keep their callback
+        n.expires = current_tick + n.period;
+        link(index);
+      } else {
+        expired.push_back(std::move(n.cb));
+        release(index);
+      }
+      index = next;
+    }
+  }
+
+  void run() {
+    std::vector<callback> expired;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stop) {
+      std::uint64_t const now = ticks_at(clock::now());
+      if (pending_count == 0) {
+        // nothing to cascade or expire: jump straight to the present.
+        current_tick = std::max(current_tick, now);
+      }
+      while (current_tick < now) {
+        advance(expired);
+      }
+
+      if (!expired.empty()) {
+        lock.unlock();
+        for (auto &cb : expired) {
+          pool.post(std::move(cb));
+        }
+        expired.clear();
+        lock.lock();
+        continue;
+      }
+
+      if (pending_count == 0) {
+        cv.wait(lock, [this] { return stop || pending_count != 0; });
+      } else {
+        cv.wait_until(lock,
+                      start + (current_tick + ticks_to_next_event()) * tick);
+      }
+    }
+  }
+
+  timer_id add(clock::duration delay, clock::duration period, callback cb) {
+    // round up, so that timers never fire early.
+    clock::time_point const due = clock::now() + delay;
+    std::uint64_t const due_tick = static_cast<std::uint64_t>(
+        (due - start + tick - clock::duration(1)) / tick);
+    std::uint64_t const period_ticks =
+        period.count() == 0
+            ? 0
+            : std::max<std::uint64_t>(1, (period + tick / 2) / tick);
+
+    timer_id id;
+    bool wake_up;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      // the timer thread sleeps until its next event, or forever when
+      // nothing is pending: it needs a notification when the new timer
+      // expires before that.
+      bool const idle = pending_count++ == 0;
+      std::uint64_t const deadline = current_tick + ticks_to_next_event();
+      std::uint32_t const index = allocate();
+      node &n = nodes[index];
+      n.cb = std::move(cb);
+      n.period = period_ticks;
+      // never expire in an already processed tick.
+      n.expires = std::max(due_tick, current_tick + 1);
+      link(index);
+
+      id = timer_id{index, n.generation};
+      wake_up = idle || n.expires < deadline;
+    }
+    if (wake_up) {
+      cv.notify_one();
+    }
+    return id;
+  }
+
+public:
+  explicit timer_wheel(thread_pool &_pool,
+                       clock::duration _tick = std::chrono::milliseconds(1))
+      : pool(_pool), tick(_tick), start(clock::now()) {
+    slots.fill(npos);
+    timer_thread = std::thread(&timer_wheel::run, this);
+  }
+
+  // Pending timers are discarded.
+  ~timer_wheel() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    cv.notify_one();
+    timer_thread.join();
+  }
+
+  // non-copiable.
+  timer_wheel(timer_wheel const &) = delete;
+  timer_wheel &operator=(timer_wheel const &) = delete;
+
+  // Runs cb once on the pool, after the given delay.
+  timer_id schedule_after(clock::duration delay, callback cb) {
+    return add(delay, clock::duration(0), std::move(cb));
+  }
+
+  // Runs cb on the pool every period, starting after first_delay.
+  timer_id schedule_every(clock::duration period, callback cb,
+                          clock::duration first_delay) {
+    return add(first_delay, period, std::move(cb));
+  }
+
+  timer_id schedule_every(clock::duration period, callback cb) {
+    return add(period, period, std::move(cb));
+  }
+
+  // Returns false if the timer already fired (one-shot) or was cancelled.
+  bool cancel(timer_id id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (id.index >= nodes.size()) {
+      return false;
+    }
+    node &n = nodes[id.index];
+    if (n.generation != id.generation || n.slot == npos) {
+      return false;
+    }
+    unlink(id.index);
+    release(id.index);
+    return true;
+  }
+
+  std::size_t pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending_count;
+  }
+};
+
+// ===================================================================
+// Benchmark
+// ===================================================================
+
+// Prints benchmark results
+void print_results(const char *const tag, std::size_t count,
+                   high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  double const ms = duration<double, milli>(endTime - startTime).count();
+  printf("%s: Time: %fms (%.1f ns/op)\n", tag, ms, ms * 1e6 / count);
+}
+
+// Schedule and cancel cost, with 10^6 pending timers.
+void schedule_cancel_benchmark(thread_pool &pool, std::size_t count) {
+  timer_wheel wheel(pool);
+
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> delay_ms(1'000, 3'600'000);
+  std::vector<std::chrono::milliseconds> delays(count);
+  for (auto &d : delays) {
+    d = std::chrono::milliseconds(delay_ms(rng));
+  }
+
+  std::vector<timer_wheel::timer_id> ids(count);
+  auto startTime = high_resolution_clock::now();
+  for (std::size_t i = 0; i < count; ++i) {
+    ids[i] = wheel.schedule_after(delays[i], [] {});
+  }
+  auto endTime = high_resolution_clock::now();
+  print_results("schedule ", count, startTime, endTime);
+  printf("pending timers: %zu\n", wheel.pending());
+
+  std::shuffle(ids.begin(), ids.end(), rng);
+  startTime = high_resolution_clock::now();
+  std::size_t cancelled = 0;
+  for (auto id : ids) {
+    cancelled += wheel.cancel(id);
+  }
+  endTime = high_resolution_clock::now();
+  print_results("cancel   ", count, startTime, endTime);
+  printf("cancelled: %zu, pending timers: %zu\n", cancelled, wheel.pending());
+}
+
+// Difference between the requested and the actual firing time.
+void jitter_benchmark(thread_pool &pool, std::size_t count) {
+  timer_wheel wheel(pool);
+
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> delay_ms(1, 1000);
+  std::vector<double> jitter(count);
+  std::atomic<std::size_t> fired{0};
+
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const delay = std::chrono::milliseconds(delay_ms(rng));
+    auto const due = timer_wheel::clock::now() + delay;
+    wheel.schedule_after(delay, [&jitter, &fired, due, i] {
+      jitter[i] =
+          duration<double, milli>(timer_wheel::clock::now() - due).count();
+      fired.fetch_add(1, std::memory_order_release);
+    });
+  }
+
+  // the pool may still run a queued tick after this function returns, so
+  // the counter is shared with the callback.
+  auto ticks = std::make_shared<std::atomic<int>>(0);
+  auto const periodic =
+      wheel.schedule_every(10ms, [ticks] { ticks->fetch_add(1); });
+
+  while (fired.load(std::memory_order_acquire) < count) {
+    std::this_thread::sleep_for(10ms);
+  }
+
+  wheel.cancel(periodic);
+
+  std::sort(jitter.begin(), jitter.end());
+  double sum = 0;
+  for (double j : jitter) {
+    sum += j;
+  }
+  printf("jitter (%zu timers): min %.3fms avg %.3fms p50 %.3fms p99 %.3fms "
+         "max %.3fms\n",
+         count, jitter.front(), sum / count, jitter[count / 2],
+         jitter[count * 99 / 100], jitter.back());
+  printf("periodic 10ms timer fired %d times in the meantime\n", ticks->load());
+}
+
+// A short timer added while a longer one is pending must wake the timer
+// thread up, which sleeps until the longer one.
+void short_after_long_check(thread_pool &pool) {
+  timer_wheel wheel(pool);
+  wheel.schedule_after(200ms, [] {});
+  std::this_thread::sleep_for(10ms); // the timer thread is asleep
+
+  // notify_one() may still run after wait() returns: the flag is shared
+  // with the callback.
+  auto fired = std::make_shared<std::atomic<bool>>(false);
+  auto const startTime = high_resolution_clock::now();
+  high_resolution_clock::time_point endTime;
+  wheel.schedule_after(5ms, [fired, &endTime] {
+    endTime = high_resolution_clock::now();
+    fired->store(true, std::memory_order_release);
+    fired->notify_one();
+  });
+  fired->wait(false, std::memory_order_acquire);
+  double const ms = duration<double, milli>(endTime - startTime).count();
+  printf("5ms timer added while a 200ms one is pending: fired after %.3fms "
+         "%s\n",
+         ms, ms < 100 ? "" : "WRONG RESULT");
+}
+
+int main(int argc, char **argv) {
+  std::size_t const count = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+
+  thread_pool pool;
+  printf("Timer wheel with %zu pool threads\n", pool.size());
+  short_after_long_check(pool);
+  schedule_cancel_benchmark(pool, count);
+  jitter_benchmark(pool, std::min<std::size_t>(count, 100'000));
+  return 0;
+}
@@ -0,0 +1,103 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+
+#include "task_scope.h"
+#include "thread_pool.h"
+
+using namespace std::literals;
+
+// ===================================================================
+// EXAMPLE 1: Cancelling a tree of tasks
+// - The root scope spawns branches, every branch opens a nested scope
+//   and spawns leaves on it.
+// - Stopping the root reaches every nested scope: queued leaves are
+//   dropped and running leaves return at their next check.
+// ===================================================================
+void tree_cancellation(thread_pool &pool) {
+  std::atomic<int> leaves_run{0};
+  std::atomic<int> leaves_stopped{0};
+  std::atomic<std::size_t> leaves_dropped{0};
+
+  task_scope root(pool);
+  for (int branch = 0; branch < 4; ++branch) {
+    root.spawn([&](std::stop_token) {
+      task_scope children(root); // inherits the root cancellation
+      for (int leaf = 0; leaf < 100; ++leaf) {
+        children.spawn([&](std::stop_token token) {
+          for (int step = 0; step < 10; ++step) {
+            if (token.stop_requested()) {
+              leaves_stopped.fetch_add(1);
+              return;
+            }
+            std::this_thread::sleep_for(1ms);
+          }
+          leaves_run.fetch_add(1);
+        });
+      }
+      children.wait();
+      leaves_dropped.fetch_add(children.dropped_count());
+    });
+  }
+
+  std::this_thread::sleep_for(50ms);
+  root.request_stop();
+  root.wait();
+
+  printf("branches dropped: %zu\n", root.dropped_count());
+  printf("leaves completed: %d, stopped while running: %d, dropped: %zu\n",
+         leaves_run.load(), leaves_stopped.load(), leaves_dropped.load());
+}
+
+// ===================================================================
+// EXAMPLE 2: Exceptions cancel the siblings
+// ===================================================================
+void exception_cancellation(thread_pool &pool) {
+  task_scope scope(pool);
+  for (int i = 0; i < 1000; ++i) {
+    scope.spawn([i]() {
+      if (i == 10) {
+        throw std::runtime_error("task 10 failed");
+      }
+      std::this_thread::sleep_for(100us);
+    });
+  }
+
+  try {
+    scope.wait();
+  } catch (std::exception const &e) {
+    printf("caught '%s', dropped %zu tasks\n", e.what(),
+           scope.dropped_count());
+  }
+}
+
+// ===================================================================
+// EXAMPLE 3: Linking a scope to a jthread stop_token
+// ===================================================================
+void jthread_cancellation(thread_pool &pool) {
+  std::atomic<std::size_t> dropped{0};
+  std::jthread owner([&](std::stop_token token) {
+    task_scope scope(pool, token);
+    for (int i = 0; i < 1000; ++i) {
+      scope.spawn([]() { std::this_thread::sleep_for(1ms); });
+    }
+    scope.wait();
+    dropped = scope.dropped_count();
+  });
+
+  std::this_thread::sleep_for(20ms);
+  owner.request_stop();
+  owner.join();
+  printf("jthread stopped, dropped %zu tasks\n", dropped.load());
+}
+
+int main() {
+  thread_pool pool;
+  tree_cancellation(pool);
+  exception_cancellation(pool);
+  jthread_cancellation(pool);
+  return 0;
+}
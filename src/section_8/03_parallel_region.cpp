@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "parallel_region.h"
+#include "thread_pool.h"
+
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+// Prints benchmark results, as iterations per second.
+void print_results(const char *const tag, std::size_t iterations,
+                   bool correct, high_resolution_clock::time_point startTime,
+                   high_resolution_clock::time_point endTime) {
+  double const seconds = duration<double>(endTime - startTime).count();
+  printf("%s: %12.0f iterations/s %s\n", tag, iterations / seconds,
+         correct ? "" : "WRONG RESULT");
+}
+
+// ===================================================================
+// 2D Jacobi relaxation, n x n, boundary fixed
+// ===================================================================
+// Every iteration computes out from in, then swaps them: the iterations
+// are phases, and no thread may start iteration k + 1 before every thread
+// is done with iteration k.
+struct grid {
+  std::size_t n;
+  std::vector<double> in;
+  std::vector<double> out;
+
+  explicit grid(std::size_t _n) : n(_n), in(_n * _n), out(_n * _n) {
+    std::mt19937_64 rng(n);
+    for (auto &v : in) {
+      v = static_cast<double>(rng() % 16);
+    }
+    out = in;
+  }
+
+  // Updates the interior rows of [first, last).
+  // Not inlined, so the three versions below run the same loop (inlined
+  // in the region body, it runs out of registers).
+  [[gnu::noinline]] void relax(std::size_t first, std::size_t last) {
+    double const *const src = in.data();
+    double *const dst = out.data();
+    for (std::size_t i = std::max<std::size_t>(first, 1);
+         i < std::min(last, n - 1); ++i) {
+      for (std::size_t j = 1; j < n - 1; ++j) {
+        dst[i * n + j] = 0.25 * (src[(i - 1) * n + j] + src[(i + 1) * n + j] +
+                                 src[i * n + j - 1] + src[i * n + j + 1]);
+      }
+    }
+  }
+};
+
+// Rows of member t of a team of num_threads.
+std::size_t row_begin(std::size_t n, std::size_t t, std::size_t num_threads) {
+  return t * n / num_threads;
+}
+
+// Version 1: new threads for every iteration, like parallel_for_each_pt.
+std::vector<double> respawn_threads(std::size_t n, std::size_t iterations,
+                                    std::size_t num_threads) {
+  grid g(n);
+  for (std::size_t k = 0; k < iterations; ++k) {
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < num_threads; ++t) {
+      threads.emplace_back([&g, n, t, num_threads] {
+        g.relax(row_begin(n, t, num_threads),
+                row_begin(n, t + 1, num_threads));
+      });
+    }
+    g.relax(0, row_begin(n, 1, num_threads));
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::swap(g.in, g.out);
+  }
+  return std::move(g.in);
+}
+
+// Version 2: one fork_join on a thread pool for every iteration.
+std::vector<double> pool_fork_join(thread_pool &pool, std::size_t n,
+                                   std::size_t iterations,
+                                   std::size_t num_threads) {
+  grid g(n);
+  for (std::size_t k = 0; k < iterations; ++k) {
+    pool.fork_join(num_threads, [&](std::size_t t) {
+      g.relax(row_begin(n, t, num_threads),
+              row_begin(n, t + 1, num_threads));
+    });
+    std::swap(g.in, g.out);
+  }
+  return std::move(g.in);
+}
+
+// Version 3: one run of a parallel region for all iterations, and a
+// barrier between them. The last member to arrive swaps the grids.
+std::vector<double> persistent_team(parallel_region &region, std::size_t n,
+                                    std::size_t iterations) {
+  grid g(n);
+  region.run([&](parallel_region::team &team) {
+    auto const [first, last] = team.range(0, n);
+    for (std::size_t k = 0; k < iterations; ++k) {
+      g.relax(first, last);
+      team.sync([&g] { std::swap(g.in, g.out); });
+    }
+  });
+  return std::move(g.in);
+}
+
+void jacobi(thread_pool &pool, parallel_region &region, std::size_t n) {
+  // about the same amount of work for every grid size.
+  std::size_t const iterations =
+      std::max<std::size_t>(10, (std::size_t(1) << 26) / (n * n));
+  std::size_t const num_threads = region.size();
+  printf("\nJacobi %zu x %zu, %zu iterations, %zu threads...\n", n, n,
+         iterations, num_threads);
+
+  auto startTime = high_resolution_clock::now();
+  std::vector<double> const expected =
+      respawn_threads(n, iterations, num_threads);
+  auto endTime = high_resolution_clock::now();
+  print_results("threads per iteration   ", iterations, true, startTime,
+                endTime);
+
+  startTime = high_resolution_clock::now();
+  std::vector<double> result =
+      pool_fork_join(pool, n, iterations, num_threads);
+  endTime = high_resolution_clock::now();
+  print_results("pool fork_join          ", iterations, result == expected,
+                startTime, endTime);
+
+  startTime = high_resolution_clock::now();
+  result = persistent_team(region, n, iterations);
+  endTime = high_resolution_clock::now();
+  print_results("parallel_region barrier ", iterations, result == expected,
+                startTime, endTime);
+}
+
+// ===================================================================
+// Barrier latency: empty phases
+// ===================================================================
+void empty_phases(parallel_region &region, std::size_t phases) {
+  std::size_t const num_threads = region.size();
+  printf("\nEmpty phases, %zu threads...\n", num_threads);
+
+  auto startTime = high_resolution_clock::now();
+  std::barrier<> std_barrier(num_threads);
+  {
+    std::vector<std::jthread> threads;
+    for (std::size_t t = 1; t < num_threads; ++t) {
+      threads.emplace_back([&] {
+        for (std::size_t k = 0; k < phases; ++k) {
+          std_barrier.arrive_and_wait();
+        }
+      });
+    }
+    for (std::size_t k = 0; k < phases; ++k) {
+      std_barrier.arrive_and_wait();
+    }
+  }
+  auto endTime = high_resolution_clock::now();
+  print_results("std::barrier            ", phases, true, startTime,
+                endTime);
+
+  startTime = high_resolution_clock::now();
+  region.run([&](parallel_region::team &team) {
+    for (std::size_t k = 0; k < phases; ++k) {
+      team.sync();
+    }
+  });
+  endTime = high_resolution_clock::now();
+  print_results("spin_barrier            ", phases, true, startTime,
+                endTime);
+}
+
+int main(int argc, char **argv) {
+  const std::size_t num_threads =
+      argc > 1 ? std::stoul(argv[1]) : thread_pool::default_thread_count();
+  thread_pool pool(num_threads);
+  parallel_region region(num_threads);
+
+  for (std::size_t n : {64, 256, 1024, 4096}) {
+    jacobi(pool, region, n);
+  }
+  empty_phases(region, 100'000);
+  return 0;
+}
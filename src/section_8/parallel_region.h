@@ -0,0 +1,221 @@
+#ifndef PARALLEL_REGION_H_
+#define PARALLEL_REGION_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "section_6/spin_hints.h"
+
+// ===================================================================
+// Sense-reversing barrier
+// ===================================================================
+// Centralized barrier for a fixed number of threads. Every thread
+// decrements a shared counter; the last one to arrive resets it and flips
+// the sense, which releases the others. The sense is a phase number
+// instead of a single bool, so threads do not need a local copy: a thread
+// reads the phase before arriving, and waits until it changes.
+// Waiting threads spin for a while (the others usually arrive within a few
+// microseconds), then sleep on the phase with std::atomic::wait. With more
+// threads than cores, spinning only burns the CPU the stragglers need:
+// the spin count should then be 0.
+// The counter and the phase live in separate cache lines: arrivals do not
+// disturb the threads spinning on the phase.
+class spin_barrier {
+  unsigned const spin_count;
+  std::atomic<std::size_t> count;
+  alignas(spin_hints::cache_line_size) std::atomic<std::size_t> remaining;
+  alignas(spin_hints::cache_line_size) std::atomic<std::uint32_t> phase{0};
+
+public:
+  static constexpr unsigned default_spin_count = 1024;
+
+  explicit spin_barrier(std::size_t _count,
+                        unsigned _spin_count = default_spin_count)
+      : spin_count(_spin_count), count(_count), remaining(_count) {}
+
+  // non-copiable.
+  spin_barrier(spin_barrier const &) = delete;
+  spin_barrier &operator=(spin_barrier const &) = delete;
+
+  // Waits for every thread. The last thread to arrive runs completion()
+  // before releasing the others: a serial step between two phases.
+  template <typename F> void arrive_and_wait(F &&completion) {
+    std::uint32_t const current = phase.load(std::memory_order_acquire);
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      completion();
+      remaining.store(count.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+      phase.store(current + 1, std::memory_order_release);
+      phase.notify_all();
+      return;
+    }
+    for (unsigned i = 0; i < spin_count; ++i) {
+      if (phase.load(std::memory_order_acquire) != current) {
+        return;
+      }
+      spin_hints::cpu_relax();
+    }
+    while (phase.load(std::memory_order_acquire) == current) {
+      phase.wait(current, std::memory_order_acquire);
+    }
+  }
+
+  void arrive_and_wait() {
+    arrive_and_wait([] {});
+  }
+
+  // Arrives without waiting, and leaves the barrier: the next phases wait
+  // for one thread less.
+  void arrive_and_drop() {
+    count.fetch_sub(1, std::memory_order_relaxed);
+    std::uint32_t const current = phase.load(std::memory_order_acquire);
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      remaining.store(count.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+      phase.store(current + 1, std::memory_order_release);
+      phase.notify_all();
+    }
+  }
+};
+
+// ===================================================================
+// Parallel region with persistent workers
+// ===================================================================
+// A team of threads created once, and reused by every run(). Iterative
+// algorithms (Jacobi relaxation, PageRank) run all their iterations inside
+// a single run(), and separate the phases with team.sync(), instead of
+// starting (or submitting) new work for every iteration.
+// - run(body) calls body(team) on every member, the calling thread being
+//   member 0, and returns when all of them are done.
+// - team.sync() is a barrier across the team; team.sync(f) runs f on one
+//   member, after every member arrived (e.g. to swap buffers).
+// - team.range(first, last) gives every member its contiguous share.
+// Between runs, the workers sleep on the same barrier. The barrier only
+// spins when every member can have a core of its own.
+// An exception thrown by the body is rethrown by run(), but the other
+// members are not interrupted: a body must not throw between two sync().
+class parallel_region {
+public:
+  class team {
+    parallel_region &region;
+    std::size_t const index;
+
+  public:
+    team(parallel_region &_region, std::size_t _index)
+        : region(_region), index(_index) {}
+
+    std::size_t thread_index() const { return index; }
+    std::size_t size() const { return region.size(); }
+
+    void sync() { region.barrier.arrive_and_wait(); }
+    template <typename F> void sync(F &&f) {
+      region.barrier.arrive_and_wait(std::forward<F>(f));
+    }
+
+    // Contiguous share of [first, last) of this member.
+    std::pair<std::size_t, std::size_t> range(std::size_t first,
+                                              std::size_t last) const {
+      std::size_t const length = last - first;
+      return {first + index * length / size(),
+              first + (index + 1) * length / size()};
+    }
+  };
+
+private:
+  spin_barrier barrier;
+  std::vector<std::thread> threads;
+
+  // the body of the current run, type-erased without allocating.
+  void (*invoke)(void const *, team &) = nullptr;
+  void const *body = nullptr;
+  bool done = false;
+
+  std::mutex exception_mutex;
+  std::exception_ptr exception;
+
+  void run_member(team &member) {
+    try {
+      invoke(body, member);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(exception_mutex);
+      if (!exception) {
+        exception = std::current_exception();
+      }
+    }
+  }
+
+  void worker_thread(std::size_t index) {
+    team member(*this, index);
+    while (true) {
+      barrier.arrive_and_wait(); // start of a run
+      if (done) {
+        return;
+      }
+      run_member(member);
+      barrier.arrive_and_wait(); // end of the run
+    }
+  }
+
+  void stop() {
+    done = true; // published by the barrier
+    barrier.arrive_and_wait();
+    for (auto &t : threads) {
+      t.join();
+    }
+  }
+
+public:
+  explicit parallel_region(
+      std::size_t team_size = std::thread::hardware_concurrency())
+      : barrier(std::max<std::size_t>(1, team_size),
+                team_size <= std::thread::hardware_concurrency()
+                    ? spin_barrier::default_spin_count
+                    : 0) {
+    team_size = std::max<std::size_t>(1, team_size);
+    try {
+      for (std::size_t i = 1; i < team_size; ++i) {
+        threads.emplace_back(&parallel_region::worker_thread, this, i);
+      }
+    } catch (...) {
+      // the members that could not start leave the barrier.
+      for (std::size_t i = threads.size() + 1; i < team_size; ++i) {
+        barrier.arrive_and_drop();
+      }
+      stop();
+      throw;
+    }
+  }
+
+  ~parallel_region() { stop(); }
+
+  // non-copiable.
+  parallel_region(parallel_region const &) = delete;
+  parallel_region &operator=(parallel_region const &) = delete;
+
+  std::size_t size() const { return threads.size() + 1; }
+
+  // Runs body(team &) on every member of the team. Not reentrant: a single
+  // thread calls run() at a time.
+  template <typename F> void run(F const &f) {
+    invoke = [](void const *b, team &member) {
+      (*static_cast<F const *>(b))(member);
+    };
+    body = &f;
+    team member(*this, 0);
+    barrier.arrive_and_wait(); // releases the workers
+    run_member(member);
+    barrier.arrive_and_wait(); // waits for them
+    if (exception) {
+      std::rethrow_exception(std::exchange(exception, nullptr));
+    }
+  }
+};
+
+#endif /* PARALLEL_REGION_H_ */
@@ -0,0 +1,130 @@
+#ifndef TASK_SCOPE_H_
+#define TASK_SCOPE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "thread_pool.h"
+
+// task_scope attaches a std::stop_source to a whole tree of tasks submitted
+// to a thread_pool.
+// - Every task spawned in the scope shares the scope stop_token. Tasks can
+//   spawn children in the same scope, or open a nested task_scope, which
+//   inherits the cancellation of its parent (but not the other way around).
+// - Once stop is requested, tasks still in the queue are dropped without
+//   running, and running tasks observe it through their stop_token, which
+//   is a single atomic load.
+// - An exception thrown by a task requests stop, and is rethrown by wait().
+// The destructor waits for every spawned task, so tasks can safely refer to
+// the scope and to the caller's stack.
+class task_scope {
+  // stop_callback needs a named callable type.
+  struct forward_stop {
+    std::stop_source target;
+    void operator()() { target.request_stop(); }
+  };
+
+  thread_pool &pool;
+  std::stop_source source;
+  std::optional<std::stop_callback<forward_stop>> parent_link;
+
+  std::atomic<std::size_t> pending{0};
+  std::atomic<std::size_t> dropped{0};
+
+  std::mutex exception_mutex;
+  std::exception_ptr exception;
+
+  template <typename F> void run(F &f) {
+    if (source.stop_requested()) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    try {
+      if constexpr (std::is_invocable_v<F &, std::stop_token>) {
+        f(source.get_token());
+      } else {
+        f();
+      }
+    } catch (...) {
+      {
+        std::lock_guard<std::mutex> lock(exception_mutex);
+        if (!exception) {
+          exception = std::current_exception();
+        }
+      }
+      source.request_stop();
+    }
+  }
+
+public:
+  explicit task_scope(thread_pool &_pool) : pool(_pool) {}
+
+  // Scope cancelled whenever the given token is (e.g. a jthread token).
+  task_scope(thread_pool &_pool, std::stop_token parent) : pool(_pool) {
+    parent_link.emplace(std::move(parent), forward_stop{source});
+  }
+
+  // Nested scope: runs on the same pool and inherits the parent cancellation.
+  explicit task_scope(task_scope &parent)
+      : task_scope(parent.pool, parent.get_token()) {}
+
+  ~task_scope() {
+    // exceptions are only reported through an explicit wait().
+    while (pending.load(std::memory_order_acquire) != 0) {
+      if (!pool.run_pending_task()) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  // non-copiable.
+  task_scope(task_scope const &) = delete;
+  task_scope &operator=(task_scope const &) = delete;
+
+  std::stop_token get_token() const { return source.get_token(); }
+  bool stop_requested() const { return source.stop_requested(); }
+  void request_stop() { source.request_stop(); }
+
+  // Number of tasks that were dropped before they started.
+  std::size_t dropped_count() const {
+    return dropped.load(std::memory_order_relaxed);
+  }
+
+  // Submits f, either callable as f() or as f(std::stop_token).
+  template <typename F> void spawn(F &&f) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    try {
+      pool.post([this, f = std::forward<F>(f)]() mutable {
+        run(f);
+        pending.fetch_sub(1, std::memory_order_release);
+      });
+    } catch (...) {
+      // never queued: wait() must not wait for it.
+      pending.fetch_sub(1, std::memory_order_relaxed);
+      throw;
+    }
+  }
+
+  // Waits for every spawned task, running pending pool tasks meanwhile.
+  // Rethrows the first exception thrown by a task.
+  void wait() {
+    while (pending.load(std::memory_order_acquire) != 0) {
+      if (!pool.run_pending_task()) {
+        std::this_thread::yield();
+      }
+    }
+    std::lock_guard<std::mutex> lock(exception_mutex);
+    if (exception) {
+      std::rethrow_exception(std::exchange(exception, nullptr));
+    }
+  }
+};
+
+#endif /* TASK_SCOPE_H_ */
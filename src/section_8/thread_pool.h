@@ -0,0 +1,233 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// function_wrapper is a move-only, type-erased void() callable.
+// std::function requires copyable targets, so it cannot hold a
+// std::packaged_task.
+class function_wrapper {
+  struct impl_base {
+    virtual void call() = 0;
+    virtual ~impl_base() {}
+  };
+
+  template <typename F> struct impl_type : impl_base {
+    F f;
+    impl_type(F &&_f) : f(std::move(_f)) {}
+    void call() override { f(); }
+  };
+
+  std::unique_ptr<impl_base> impl;
+
+public:
+  function_wrapper() = default;
+
+  template <typename F>
+    requires(!std::is_same_v<std::decay_t<F>, function_wrapper>)
+  function_wrapper(F &&f)
+      : impl(new impl_type<std::decay_t<F>>(std::forward<F>(f))) {}
+
+  function_wrapper(function_wrapper &&other) = default;
+  function_wrapper &operator=(function_wrapper &&other) = default;
+
+  // non-copiable.
+  function_wrapper(function_wrapper const &) = delete;
+  function_wrapper &operator=(function_wrapper const &) = delete;
+
+  void operator()() { impl->call(); }
+  explicit operator bool() const { return impl != nullptr; }
+};
+
+// thread_pool runs submitted tasks on a fixed set of worker threads, which
+// feed from a single work queue.
+// - submit() returns a std::future with the result (or the exception).
+// - post() is fire and forget.
+// - Threads waiting for a task of the pool should call wait(), which runs
+//   other pending tasks instead of blocking. This avoids deadlocks when
+//   tasks wait on tasks (e.g. divide and conquer algorithms).
+// - Coroutines move onto the pool with co_await pool.schedule().
+// Tasks still in the queue are run before the destructor returns.
+class thread_pool {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<function_wrapper> queue;
+  bool done = false;
+  std::atomic<unsigned> idle{0};
+  std::vector<std::thread> threads;
+
+  void worker_thread() {
+    while (true) {
+      function_wrapper task;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!done && queue.empty()) {
+          idle.fetch_add(1, std::memory_order_relaxed);
+          cv.wait(lock, [this] { return done || !queue.empty(); });
+          idle.fetch_sub(1, std::memory_order_relaxed);
+        }
+        if (queue.empty()) {
+          return; // done and drained
+        }
+        task = std::move(queue.front());
+        queue.pop_front();
+      }
+      task();
+    }
+  }
+
+public:
+  static unsigned default_thread_count() {
+    unsigned const hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads != 0 ? hardware_threads : 2;
+  }
+
+  explicit thread_pool(unsigned thread_count = default_thread_count()) {
+    try {
+      for (unsigned i = 0; i < thread_count; ++i) {
+        threads.emplace_back(&thread_pool::worker_thread, this);
+      }
+    } catch (...) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+      }
+      cv.notify_all();
+      for (auto &t : threads) {
+        t.join();
+      }
+      throw;
+    }
+  }
+
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      done = true;
+    }
+    cv.notify_all();
+    for (auto &t : threads) {
+      t.join();
+    }
+  }
+
+  // non-copiable.
+  thread_pool(thread_pool const &) = delete;
+  thread_pool &operator=(thread_pool const &) = delete;
+
+  std::size_t size() const { return threads.size(); }
+
+  // Number of workers waiting for tasks. It is only a hint, as it may change
+  // right after being read, but it tells whether splitting work further
+  // would keep more threads busy.
+  unsigned idle_workers() const {
+    return idle.load(std::memory_order_relaxed);
+  }
+
+  // Enqueues a task without any way to wait for it.
+  template <typename F> void post(F &&f) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.emplace_back(std::forward<F>(f));
+    }
+    cv.notify_one();
+  }
+
+  // Awaitable that resumes the awaiting coroutine on a worker:
+  //   co_await pool.schedule(); // now running on the pool
+  auto schedule() {
+    struct awaiter {
+      thread_pool &pool;
+
+      bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> handle) {
+        pool.post([handle] { handle.resume(); });
+      }
+      void await_resume() const noexcept {}
+    };
+    return awaiter{*this};
+  }
+
+  // Enqueues a task and returns a future for its result.
+  template <typename F>
+  std::future<std::invoke_result_t<std::decay_t<F> &>> submit(F &&f) {
+    using result_type = std::invoke_result_t<std::decay_t<F> &>;
+    std::packaged_task<result_type()> task(std::forward<F>(f));
+    std::future<result_type> result(task.get_future());
+    post(std::move(task));
+    return result;
+  }
+
+  // Runs one queued task in the calling thread, if there is any.
+  bool run_pending_task() {
+    function_wrapper task;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (queue.empty()) {
+        return false;
+      }
+      task = std::move(queue.front());
+      queue.pop_front();
+    }
+    task();
+    return true;
+  }
+
+  // Waits for the future to be ready, running pending tasks meanwhile.
+  template <typename T> void wait(std::future<T> const &f) {
+    while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      if (!run_pending_task()) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  // Runs f(0), ..., f(count - 1) as pool tasks, the last one in the calling
+  // thread, and waits for all of them. Rethrows the first exception.
+  template <typename F> void fork_join(std::size_t count, F const &f) {
+    if (count == 0) {
+      return;
+    }
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(count - 1);
+    for (std::size_t i = 0; i + 1 < count; ++i) {
+      futures.push_back(submit([&f, i] { f(i); }));
+    }
+
+    std::exception_ptr error;
+    try {
+      f(count - 1);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    // every task refers to f, so all of them must finish before returning.
+    for (auto &future : futures) {
+      wait(future);
+      try {
+        future.get();
+      } catch (...) {
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+};
+
+#endif /* THREAD_POOL_H_ */